@@ -0,0 +1,389 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Benchmark harness: times each phase of opening and comparing a file pair and
+// reports throughput and peak memory, optionally on a freshly generated corpus.
+
+// Project includes
+#include "Compare.h"
+#include "Corpus.h"
+#include "DiffWriter.h"
+#include "File.h"
+#include "Server.h"
+#include "StreamReader.h"
+#include "Timer.h"
+
+// AbeArgs includes
+#include "abeargs.h"
+
+// System includes
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+// @brief Reset the peak resident set size, so each phase reports its own peak.
+//        Only Linux can do this; elsewhere the peak covers all phases so far.
+void
+resetPeakRss()
+{
+#if defined(__linux__)
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+#endif
+}
+
+// @brief The peak resident set size in KiB.
+long
+getPeakRssKb()
+{
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return std::atol(line.c_str() + 6);
+    }
+    return 0;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+// A phase reports the bytes and lines it worked through, for the rates.
+using Phase = std::function<void(uint64_t& bytes, int64_t& lines)>;
+
+// @brief Run one phase and print a row of the report.
+void
+runPhase(const std::string& name, const Phase& phase)
+{
+    resetPeakRss();
+    uint64_t bytes = 0;
+    int64_t lines = 0;
+    Timer timer;
+    timer.start();
+    phase(bytes, lines);
+    timer.stop();
+    const double seconds = std::max(timer.getElapsedSeconds(), 1e-9);
+    printf("%-22s %10.1f ms %10.1f MB/s %10.2f Mlines/s %10ld KiB\n", name.c_str(), seconds * 1000.0, bytes / seconds / 1e6,
+           lines / seconds / 1e6, getPeakRssKb());
+}
+
+// @brief Send batches of the file pair to a comparison server from several
+//        clients at once, and print the throughput and the batch latencies.
+//        Each client has its own connection, so the batches overlap on the
+//        server the way independent callers would.
+int
+runServerBench(const std::string& socket_path, const std::string& name_a, const std::string& name_b, long requests, int batch_pairs,
+               int clients)
+{
+    const std::vector<AbeCmp::FilePair> pairs(static_cast<size_t>(batch_pairs), AbeCmp::FilePair(name_a, name_b));
+    std::vector<double> latencies(static_cast<size_t>(requests), 0.0);
+    std::atomic<long> next{ 0 };
+    std::atomic<long> failed{ 0 };
+    std::atomic<long> differed{ 0 };
+
+    Timer wall;
+    wall.start();
+    std::vector<std::thread> workers;
+    for (int c = 0; c < clients; ++c) {
+        workers.emplace_back([&]() {
+            AbeCmp::CompareClient client;
+            if (!client.connect(socket_path)) {
+                failed += 1;
+                return;
+            }
+            for (long i = next++; i < requests; i = next++) {
+                AbeCmp::BatchReply totals;
+                Timer timer;
+                timer.start();
+                if (!client.compareBatch(pairs, [](const AbeCmp::PairReply&) {}, totals)) {
+                    failed += 1;
+                    return;
+                }
+                timer.stop();
+                latencies[static_cast<size_t>(i)] = timer.getElapsedSeconds() * 1000.0;
+                differed += totals.differed + totals.errors;
+            }
+        });
+    }
+    for (auto& worker : workers)
+        worker.join();
+    wall.stop();
+    if (failed != 0) {
+        std::cerr << "\nerror: Talking to the server at: " << socket_path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](double p) { return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))]; };
+    const double seconds = std::max(wall.getElapsedSeconds(), 1e-9);
+    printf("\n%ld batches of %d pairs from %d clients in %.1f ms: %.0f pairs/s, %.0f batches/s\n", requests, batch_pairs, clients,
+           seconds * 1000.0, requests * batch_pairs / seconds, requests / seconds);
+    printf("batch latency: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n", percentile(0.50), percentile(0.90), percentile(0.99),
+           latencies.back());
+    printf("%ld pairs differed or failed.\n", differed.load());
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    const int FILE_A_ID = 1;     // File a.
+    const int FILE_B_ID = 2;     // File b.
+    const int GENERATE_ID = 3;   // Generate a corpus into this directory.
+    const int SIZE_ID = 4;       // Size of the generated files in MiB.
+    const int LENGTH_ID = 5;     // Mean line length.
+    const int DIST_ID = 6;       // Line length distribution.
+    const int LE_ID = 7;         // Line endings.
+    const int DIFFS_ID = 8;      // Changed lines per million.
+    const int SEED_ID = 9;       // Random seed.
+    const int JOBS_ID = 10;      // Threads for the parallel compare phase.
+    const int SERVER_ID = 11;    // Benchmark a comparison server on this socket.
+    const int REQUESTS_ID = 12;  // Batches to send to the server.
+    const int BATCH_ID = 13;     // File pairs per batch.
+    const int CLIENTS_ID = 14;   // Concurrent server clients.
+    const int HELP_ID = 15;      // Print out usage help.
+
+    AbeArgs::Parser parser;
+    parser.addArgument({ AbeArgs::OPTIONAL, FILE_A_ID, "a", "file-a", "File a to benchmark.", AbeArgs::FILE_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, FILE_B_ID, "b", "file-b", "File b to benchmark.", AbeArgs::FILE_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, GENERATE_ID, "g", "generate", "Generate a.txt and b.txt in this directory and benchmark them.", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, SIZE_ID, "s", "size", "Size of the generated files in MiB.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, LENGTH_ID, "l", "line-length", "Mean length of the generated lines.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, DIST_ID, "D", "distribution", "Line lengths: fixed, uniform or exponential.", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, LE_ID, "e", "line-ending", "Line endings: lf, crlf or mixed.", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, DIFFS_ID, "r", "diff-rate", "Changed lines per million lines.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, SEED_ID, "S", "seed", "Seed of the generated corpus.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, JOBS_ID, "j", "jobs", "Threads for the parallel compare phase (0 uses every core).", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, SERVER_ID, "C", "server", "Benchmark the abecmp --serve server on this socket.", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, REQUESTS_ID, "n", "requests", "Batches to send to the server.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, BATCH_ID, "p", "batch", "File pairs per batch sent to the server.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, CLIENTS_ID, "k", "clients", "Concurrent clients, each on its own connection.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::X_SWITCH, HELP_ID, "h", "help", "Show this help information and exit." });
+
+    std::string name_a, name_b, corpus_dir;
+    AbeCmp::CorpusOptions corpus;
+    int jobs = 0;
+    std::string server_path;
+    long requests = 1000;
+    int batch_pairs = 1;
+    int clients = 1;
+    parser.getArgument(SIZE_ID).setDefaultValue(static_cast<int>(corpus.size >> 20));
+    parser.getArgument(LENGTH_ID).setDefaultValue(static_cast<int>(corpus.line_length));
+    parser.getArgument(DIST_ID).setDefaultValue(std::string("uniform"));
+    parser.getArgument(LE_ID).setDefaultValue(std::string("lf"));
+    parser.getArgument(DIFFS_ID).setDefaultValue(static_cast<int>(corpus.diffs_per_million));
+    parser.getArgument(SEED_ID).setDefaultValue(static_cast<int>(corpus.seed));
+    parser.getArgument(JOBS_ID).setDefaultValue(jobs);
+    parser.getArgument(REQUESTS_ID).setDefaultValue(static_cast<int>(requests));
+    parser.getArgument(BATCH_ID).setDefaultValue(batch_pairs);
+    parser.getArgument(CLIENTS_ID).setDefaultValue(clients);
+
+    AbeArgs::ParsedArguments_t results = parser.exec(argc, argv);
+    if (parser.error()) {
+        std::cerr << "\n"
+                  << parser.getErrorMsg() << "\n";
+        return EXIT_FAILURE;
+    }
+    for (const auto& r : results) {
+        switch (r.first) {
+            case FILE_A_ID:
+                name_a = std::get<std::string>(r.second);
+                break;
+            case FILE_B_ID:
+                name_b = std::get<std::string>(r.second);
+                break;
+            case GENERATE_ID:
+                corpus_dir = std::get<std::string>(r.second);
+                break;
+            case SIZE_ID:
+                corpus.size = static_cast<uint64_t>(std::max(1, std::get<int>(r.second))) << 20;
+                break;
+            case LENGTH_ID:
+                corpus.line_length = static_cast<unsigned>(std::max(0, std::get<int>(r.second)));
+                break;
+            case DIST_ID:
+                if (!AbeCmp::parseLengthDistribution(std::get<std::string>(r.second), corpus.distribution)) {
+                    std::cerr << "\nerror: Unknown line length distribution: " << std::get<std::string>(r.second) << "\n";
+                    return EXIT_FAILURE;
+                }
+                break;
+            case LE_ID:
+                if (!AbeCmp::parseCorpusLineEnding(std::get<std::string>(r.second), corpus.line_ending)) {
+                    std::cerr << "\nerror: Unknown line ending: " << std::get<std::string>(r.second) << "\n";
+                    return EXIT_FAILURE;
+                }
+                break;
+            case DIFFS_ID:
+                corpus.diffs_per_million = static_cast<unsigned>(std::max(0, std::get<int>(r.second)));
+                break;
+            case SEED_ID:
+                corpus.seed = static_cast<uint64_t>(std::get<int>(r.second));
+                break;
+            case JOBS_ID:
+                jobs = std::max(0, std::get<int>(r.second));
+                break;
+            case SERVER_ID:
+                server_path = std::get<std::string>(r.second);
+                break;
+            case REQUESTS_ID:
+                requests = std::max(1, std::get<int>(r.second));
+                break;
+            case BATCH_ID:
+                batch_pairs = std::max(1, std::get<int>(r.second));
+                break;
+            case CLIENTS_ID:
+                clients = std::max(1, std::get<int>(r.second));
+                break;
+            case HELP_ID:
+                printf("abecmp_bench: time each phase of opening and comparing a file pair.\n\nHelp:\n");
+                for (const auto& argument : parser.getArguments())
+                    std::cout << argument.toString() << "\n";
+                return EXIT_SUCCESS;
+        }
+    }
+
+    if (!corpus_dir.empty()) {
+        name_a = corpus_dir + "/a.txt";
+        name_b = corpus_dir + "/b.txt";
+        AbeCmp::CorpusStats stats;
+        Timer timer;
+        timer.start();
+        if (!AbeCmp::generateCorpus(name_a, name_b, corpus, stats)) {
+            std::cerr << "\nerror: Generating the corpus in: " << corpus_dir << "\n";
+            return EXIT_FAILURE;
+        }
+        timer.stop();
+        printf("Generated %llu lines (%llu changed), %llu bytes per file in %.1f s.\n", static_cast<unsigned long long>(stats.lines),
+               static_cast<unsigned long long>(stats.changed_lines), static_cast<unsigned long long>(stats.bytes_a), timer.getElapsedSeconds());
+    }
+    if (name_a.empty() || name_b.empty()) {
+        std::cerr << "\nerror: Give -a and -b, or -g to generate a corpus.\n";
+        return EXIT_FAILURE;
+    }
+    if (!server_path.empty())
+        return runServerBench(server_path, name_a, name_b, requests, batch_pairs, clients);
+
+    const unsigned threads = (jobs == 0) ? std::max(1u, std::thread::hardware_concurrency()) : static_cast<unsigned>(jobs);
+    AbeCmp::File file_a, file_b;
+    bool ok = true;
+
+    printf("\n%-22s %13s %15s %19s %14s\n", "phase", "time", "throughput", "lines", "peak RSS");
+    // The first opens include reading the disk, later ones run on warm pages.
+    const auto open_both = [&](bool with_line_index) {
+        return [&, with_line_index](uint64_t& bytes, int64_t& lines) {
+            ok = file_a.open(name_a, with_line_index) && file_b.open(name_b, with_line_index);
+            bytes = file_a.getSize() + file_b.getSize();
+            lines = file_a.getLineCount() + file_b.getLineCount();
+        };
+    };
+    runPhase("open", open_both(false));
+    if (!ok) {
+        std::cerr << "\nerror: Opening the files.\n";
+        return EXIT_FAILURE;
+    }
+    runPhase("open (warm)", open_both(false));
+    runPhase("open (line index)", open_both(true));
+    file_a.open(name_a);
+    file_b.open(name_b);
+
+    const uint64_t size = file_a.getSize() + file_b.getSize();
+    const int64_t line_count = std::min(file_a.getLineCount(), file_b.getLineCount());
+    const bool le_differ = AbeCmp::lineEndingsDiffer(file_a, file_b);
+    runPhase("first difference", [&](uint64_t& bytes, int64_t& lines) {
+        const AbeCmp::MatchPoint start = AbeCmp::findFirstDifference(file_a, file_b, le_differ);
+        bytes = start.identical ? size : start.offset_a + start.offset_b;
+        lines = start.identical ? line_count : start.line;
+    });
+
+    // The line loops start at line 0, so they cover all lines and not just the
+    // part after the first difference.
+    AbeCmp::CompareOptions options;
+    options.with_pretty_le = le_differ;
+    const auto keep_going = [](const AbeCmp::LineDiff&) { return true; };
+    int64_t line_diffs = 0;
+    const auto compare_all = [&](uint64_t& bytes, int64_t& lines) {
+        line_diffs = AbeCmp::compareLines(file_a, file_b, AbeCmp::MatchPoint(), line_count, options, keep_going);
+        bytes = size;
+        lines = line_count;
+    };
+    runPhase("compare lines", compare_all);
+    options.jobs = threads;
+    runPhase("compare lines -j " + std::to_string(threads), compare_all);
+    options.jobs = 1;
+
+#if defined(_WIN32)
+    FILE* null_out = fopen("NUL", "wb");
+#else
+    FILE* null_out = fopen("/dev/null", "wb");
+#endif
+    if (null_out != nullptr) {
+        runPhase("compare + write text", [&](uint64_t& bytes, int64_t& lines) {
+            AbeCmp::DiffWriter writer(AbeCmp::OutputFormat::TEXT, null_out);
+            int64_t number = 0;
+            AbeCmp::compareLines(file_a, file_b, AbeCmp::MatchPoint(), line_count, options, [&](const AbeCmp::LineDiff& diff) {
+                writer.writeLineDiff(diff, ++number);
+                return true;
+            });
+            bytes = size;
+            lines = line_count;
+        });
+        fclose(null_out);
+    }
+    file_a.close();
+    file_b.close();
+
+    runPhase("stream compare", [&](uint64_t& bytes, int64_t& lines) {
+        AbeCmp::StreamReader stream_a, stream_b;
+        if (!stream_a.open(name_a) || !stream_b.open(name_b))
+            return;
+        lines = AbeCmp::compareStreams(stream_a, stream_b, false, options, keep_going).compared;
+        bytes = size;
+    });
+
+    printf("\n%llu bytes and %lld lines per file pair, %lld lines differ.\n", static_cast<unsigned long long>(size), static_cast<long long>(line_count),
+           static_cast<long long>(line_diffs));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "Corpus.h"
+
+// System includes.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace AbeCmp {
+
+// Lines are slices of a pool of random printable text, so generating tens of GB
+// costs little more than writing it.
+const static size_t text_pool_size = 1 << 20;
+// Write each file in blocks of this size.
+const static size_t corpus_block_size = 4 << 20;
+
+namespace {
+
+// @brief A small, fast generator (splitmix64) so a seed always makes the same corpus.
+class Random
+{
+  public:
+    explicit Random(uint64_t seed)
+      : m_state(seed)
+    {
+    }
+
+    uint64_t next()
+    {
+        uint64_t z = (m_state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // A value in [0, 1).
+    double unit() { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0); }
+
+  private:
+    uint64_t m_state;
+};
+
+// @brief Pick the length of the next line.
+size_t
+nextLength(Random& random, const CorpusOptions& options)
+{
+    const double mean = options.line_length;
+    double length = mean;
+    switch (options.distribution) {
+        case LengthDistribution::FIXED:
+            break;
+        case LengthDistribution::UNIFORM:
+            length = random.unit() * 2.0 * mean;
+            break;
+        case LengthDistribution::EXPONENTIAL:
+            length = -mean * std::log(1.0 - random.unit());
+            break;
+    }
+    return std::min(static_cast<size_t>(length), text_pool_size / 2);
+}
+
+// @brief Write out a block once it is full (or always, when last is set).
+bool
+writeBlock(FILE* file, std::string& block, bool last)
+{
+    if (block.size() < corpus_block_size && !last)
+        return true;
+    const bool ok = fwrite(block.data(), 1, block.size(), file) == block.size();
+    block.clear();
+    return ok;
+}
+
+} // namespace
+
+bool
+parseLengthDistribution(const std::string& name, LengthDistribution& distribution)
+{
+    if (name == "fixed")
+        distribution = LengthDistribution::FIXED;
+    else if (name == "uniform")
+        distribution = LengthDistribution::UNIFORM;
+    else if (name == "exponential")
+        distribution = LengthDistribution::EXPONENTIAL;
+    else
+        return false;
+    return true;
+}
+
+bool
+parseCorpusLineEnding(const std::string& name, CorpusLineEnding& line_ending)
+{
+    if (name == "lf")
+        line_ending = CorpusLineEnding::LF;
+    else if (name == "crlf")
+        line_ending = CorpusLineEnding::CRLF;
+    else if (name == "mixed")
+        line_ending = CorpusLineEnding::MIXED;
+    else
+        return false;
+    return true;
+}
+
+// @brief Write a pair of files where file b is file a with some lines changed.
+//        A changed line keeps its length and has one character flipped, which is
+//        the hardest kind of difference for a block compare to skip.
+bool
+generateCorpus(const std::string& path_a, const std::string& path_b, const CorpusOptions& options, CorpusStats& stats)
+{
+    stats = CorpusStats();
+    FILE* file_a = fopen(path_a.c_str(), "wb");
+    if (file_a == nullptr)
+        return false;
+    FILE* file_b = fopen(path_b.c_str(), "wb");
+    if (file_b == nullptr) {
+        fclose(file_a);
+        return false;
+    }
+
+    Random random(options.seed);
+    std::vector<char> pool(text_pool_size);
+    for (auto& c : pool)
+        c = static_cast<char>('!' + random.next() % ('~' - '!' + 1));
+
+    std::string block_a, block_b;
+    block_a.reserve(corpus_block_size + text_pool_size);
+    block_b.reserve(corpus_block_size + text_pool_size);
+    std::string line;
+    bool ok = true;
+    while (ok && stats.bytes_a < options.size) {
+        const size_t length = nextLength(random, options);
+        const size_t offset = random.next() % (text_pool_size - length + 1);
+        line.assign(pool.data() + offset, length);
+
+        bool crlf = (options.line_ending == CorpusLineEnding::CRLF);
+        if (options.line_ending == CorpusLineEnding::MIXED)
+            crlf = (random.next() & 1) != 0;
+        const char* le = crlf ? "\r\n" : "\n";
+
+        block_a += line;
+        block_a += le;
+        if (length > 0 && random.next() % 1000000 < options.diffs_per_million) {
+            line[random.next() % length] ^= 1;
+            ++stats.changed_lines;
+        }
+        block_b += line;
+        block_b += le;
+
+        ++stats.lines;
+        stats.bytes_a += length + (crlf ? 2 : 1);
+        stats.bytes_b += length + (crlf ? 2 : 1);
+        ok = writeBlock(file_a, block_a, false) && writeBlock(file_b, block_b, false);
+    }
+    ok = ok && writeBlock(file_a, block_a, true) && writeBlock(file_b, block_b, true);
+    ok = (fclose(file_a) == 0) && ok;
+    ok = (fclose(file_b) == 0) && ok;
+    return ok;
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,73 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// System includes.
+#include <cstdint>
+#include <string>
+
+namespace AbeCmp {
+
+// How the lengths of generated lines are spread around the mean.
+enum class LengthDistribution
+{
+    FIXED,
+    UNIFORM,
+    EXPONENTIAL
+};
+
+// The line endings of a generated corpus. Mixed picks LF or CRLF per line.
+enum class CorpusLineEnding
+{
+    LF,
+    CRLF,
+    MIXED
+};
+
+// The shape of a generated file pair.
+struct CorpusOptions
+{
+    // The size of file a in bytes.
+    uint64_t size = uint64_t(256) << 20;
+    // The mean line length, without the line ending.
+    unsigned line_length = 80;
+    LengthDistribution distribution = LengthDistribution::UNIFORM;
+    CorpusLineEnding line_ending = CorpusLineEnding::LF;
+    // Lines of file b that differ from file a, per million lines.
+    unsigned diffs_per_million = 100;
+    uint64_t seed = 1;
+};
+
+// What was generated.
+struct CorpusStats
+{
+    uint64_t lines = 0;
+    uint64_t changed_lines = 0;
+    uint64_t bytes_a = 0;
+    uint64_t bytes_b = 0;
+};
+
+// Look up a distribution or line ending by its command line name. Returns false for unknown names.
+bool parseLengthDistribution(const std::string& name, LengthDistribution& distribution);
+bool parseCorpusLineEnding(const std::string& name, CorpusLineEnding& line_ending);
+
+// Write a pair of files where file b is file a with some lines changed.
+// Files are written front to back in large blocks, so any size fits in memory.
+bool generateCorpus(const std::string& path_a, const std::string& path_b, const CorpusOptions& options, CorpusStats& stats);
+
+} // namespace AbeCmp
@@ -0,0 +1,46 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// The public interface of libabecmp, for embedding the comparer.
+//
+// Open both files with File::open(), skip the equal prefix with
+// findFirstDifference(), then either walk the lines yourself with lines() and
+// LineIterator, which hand out views into the file contents, or let
+// compareLines() or diffFiles() find the differences. Pipes and other inputs
+// that can't be mapped are read with StreamReader and compareStreams().
+// Files compared byte by byte are opened with File::openBytes() and compared
+// with compareBytes(). Files that grow, like logs, are followed with Follower,
+// which compares only the lines added since its last update.
+
+#include "BinaryCompare.h"
+#include "Compare.h"
+#include "Decompressor.h"
+#include "Diff.h"
+#include "DiffWriter.h"
+#include "ExternalDiff.h"
+#include "File.h"
+#include "Follow.h"
+#include "LineIterator.h"
+#include "Normalize.h"
+#include "ScanCache.h"
+#include "Server.h"
+#include "Similarity.h"
+#include "Stats.h"
+#include "StreamReader.h"
+#include "TreeCompare.h"
@@ -0,0 +1,98 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "Stats.h"
+
+// System includes.
+#include <cstdlib>
+#include <new>
+
+// The replacement allocation functions count allocations for --stats. The
+// count is a relaxed atomic add that only happens when stats are on. They are
+// kept apart from the code that calls new and delete, so the compiler doesn't
+// inline malloc and free into those calls and warn that they don't match.
+
+namespace {
+
+// @brief Allocate with an alignment above the default, as the aligned forms
+//        of new need.
+void*
+allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_WIN32)
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // aligned_alloc takes a size that is a multiple of the alignment.
+    const std::size_t rounded = (size + align - 1) / align * align;
+    return std::aligned_alloc(align, rounded == 0 ? align : rounded);
+#endif
+}
+
+void
+freeAligned(void* p)
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void*
+operator new(std::size_t size)
+{
+    AbeCmp::Stats::countAllocation(size);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void*
+operator new(std::size_t size, std::align_val_t alignment)
+{
+    AbeCmp::Stats::countAllocation(size);
+    if (void* p = allocateAligned(size, alignment))
+        return p;
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void* p, std::align_val_t) noexcept
+{
+    freeAligned(p);
+}
+
+void
+operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+    freeAligned(p);
+}
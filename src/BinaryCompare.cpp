@@ -0,0 +1,65 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Project includes.
+#include "BinaryCompare.h"
+#include "Scanner.h"
+#include "Stats.h"
+
+// System includes.
+#include <algorithm>
+
+namespace AbeCmp {
+
+// @brief Compare the bytes that both files have.
+BinaryCompareResult
+compareBytes(const File& file_a, const File& file_b, const ByteDiffHandler& handler)
+{
+    ScopedPhase phase(StatPhase::COMPARE);
+    const char* a = file_a.getData();
+    const char* b = file_b.getData();
+    const size_t size = std::min(file_a.getSize(), file_b.getSize());
+    BinaryCompareResult result;
+    result.compared = size;
+
+    if (!handler) {
+        result.differences = countMismatches(a, b, size);
+        phase.addBytes(2 * size);
+        return result;
+    }
+
+    for (size_t pos = 0; pos < size; ++pos) {
+        pos += findMismatch(a + pos, b + pos, size - pos);
+        if (pos == size)
+            break;
+        ByteDiff diff;
+        diff.offset = pos;
+        diff.byte_a = static_cast<unsigned char>(a[pos]);
+        diff.byte_b = static_cast<unsigned char>(b[pos]);
+        ++result.differences;
+        if (!handler(diff)) {
+            --result.differences;
+            result.compared = pos;
+            result.stopped = true;
+            break;
+        }
+    }
+    phase.addBytes(2 * result.compared);
+    return result;
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,59 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "File.h"
+
+// System includes.
+#include <cstdint>
+#include <functional>
+
+namespace AbeCmp {
+
+// A byte that differs between two files.
+struct ByteDiff
+{
+    // Zero based offset of the byte.
+    uint64_t offset = 0;
+    unsigned char byte_a = 0;
+    unsigned char byte_b = 0;
+};
+
+// Receives each differing byte in file order. Returns false to stop the comparison.
+using ByteDiffHandler = std::function<bool(const ByteDiff& diff)>;
+
+// The outcome of comparing the bytes of two files.
+struct BinaryCompareResult
+{
+    // The number of bytes compared: the bytes both files have, or the bytes
+    // before the difference that stopped the comparison.
+    uint64_t compared = 0;
+    // The number of differing bytes (passed to the handler, if there is one).
+    uint64_t differences = 0;
+    // True if the handler stopped the comparison.
+    bool stopped = false;
+};
+
+// Compare the bytes that both files have, like cmp -l. The differing bytes are
+// found with the vector mismatch kernel, which skips equal runs at memory speed.
+// Without a handler, the differing bytes are only counted, with a vector kernel
+// that counts every byte as fast as it can be read.
+BinaryCompareResult compareBytes(const File& file_a, const File& file_b, const ByteDiffHandler& handler);
+
+} // namespace AbeCmp
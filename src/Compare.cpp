@@ -0,0 +1,477 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "Compare.h"
+#include "Scanner.h"
+#include "Stats.h"
+#include "ThreadPool.h"
+
+// System includes.
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace AbeCmp {
+
+namespace {
+
+// @brief Return the offset of the start of the line that holds the byte at offset.
+size_t
+lineStart(const char* data, size_t offset)
+{
+    while (offset > 0 && data[offset - 1] != '\n')
+        --offset;
+    return offset;
+}
+
+// Don't split the lines into chunks smaller than this.
+const int64_t min_chunk_lines = 16 * 1024;
+// Aim for this many chunks per job so that uneven chunks balance out.
+const int64_t chunks_per_job = 8;
+
+// How the line endings of two files are compared, fixed for a whole comparison.
+enum class LineEndings
+{
+    // Every line of both files ends the same way, so comparing the text is enough.
+    SAME,
+    // The endings differ somewhere and count, so each line's ending is compared.
+    COMPARED,
+    // A CRLF in one file matches a LF in the other.
+    IGNORED
+};
+
+// @brief Pick how line endings are compared for two files.
+LineEndings
+getLineEndings(const File& file_a, const File& file_b, const CompareOptions& options)
+{
+    if (options.le_ignore)
+        return LineEndings::IGNORED;
+    return lineEndingsDiffer(file_a, file_b) ? LineEndings::COMPARED : LineEndings::SAME;
+}
+
+// @brief The offset of a line, or of the end of the file for the line after the last.
+size_t
+lineOffset(const File& file, int64_t line)
+{
+    return line >= file.getLineCount() ? file.getSize() : file.findLine(line);
+}
+
+// @brief Check two lines viewed with getLine() for a difference. The checks
+//        that don't apply to a comparison are compiled out.
+template<LineEndings Endings, bool Normalized>
+bool
+linesDiffer(const File& file_a, const File& file_b, std::string_view line_a, std::string_view line_b, const Normalization& normalization)
+{
+    if constexpr (Endings == LineEndings::COMPARED) {
+        if (file_a.endsInCrlf(line_a) != file_b.endsInCrlf(line_b))
+            return true;
+    }
+    if constexpr (Normalized)
+        return !equalNormalized(line_a, line_b, normalization);
+    else
+        return line_a != line_b;
+}
+
+// @brief Pass a differing line to emit. Returns what emit returns.
+template<typename Emit>
+bool
+emitLineDiff(const File& file_a, const File& file_b, int64_t line, std::string_view line_a, std::string_view line_b, const CompareOptions& options,
+             Emit& emit)
+{
+    LineDiff diff;
+    diff.line = line;
+    if (options.keep_lines) {
+        diff.line_a = line_a;
+        diff.line_b = line_b;
+        if (options.with_pretty_le) {
+            diff.pretty_le_a = file_a.getPrettyLE(line_a);
+            diff.pretty_le_b = file_b.getPrettyLE(line_b);
+        }
+        diff.no_newline_a = (line == file_a.getLineCount() - 1 && !file_a.endsInNewline());
+        diff.no_newline_b = (line == file_b.getLineCount() - 1 && !file_b.endsInNewline());
+        diff.crlf_a = !diff.no_newline_a && file_a.endsInCrlf(line_a);
+        diff.crlf_b = !diff.no_newline_b && file_b.endsInCrlf(line_b);
+    }
+    return emit(std::move(diff));
+}
+
+// @brief Compare lines [first, last) under a normalization, one line at a time.
+//        The raw bytes say nothing under a normalization, so each pair of lines
+//        is compared by equalNormalized().
+template<LineEndings Endings, typename Emit>
+int64_t
+compareNormalizedRange(const File& file_a, const File& file_b, int64_t first, int64_t last, size_t offset_a, size_t offset_b, const CompareOptions& options,
+                       Emit& emit)
+{
+    int64_t line_diffs = 0;
+    for (int64_t i = first; i < last; ++i) {
+        const std::string_view line_a = file_a.getLine(offset_a);
+        const std::string_view line_b = file_b.getLine(offset_b);
+        if (linesDiffer<Endings, true>(file_a, file_b, line_a, line_b, options.normalization)) {
+            ++line_diffs;
+            if (!emitLineDiff(file_a, file_b, i, line_a, line_b, options, emit))
+                break;
+        }
+    }
+    return line_diffs;
+}
+
+// @brief Compare lines [first, last) by their bytes. Runs of equal bytes hold
+//        only equal lines, so they are skipped with the vector mismatch kernel
+//        and their LFs counted, and only the lines from each mismatch to the
+//        next equal line are looked at. Ignored line endings step over a CR
+//        that faces a LF, as findFirstDifference() does.
+template<LineEndings Endings, typename Emit>
+int64_t
+compareRawRange(const File& file_a, const File& file_b, int64_t first, int64_t last, size_t offset_a, size_t offset_b, const CompareOptions& options,
+                Emit& emit)
+{
+    const char* a = file_a.getData();
+    const char* b = file_b.getData();
+    const size_t end_a = lineOffset(file_a, last);
+    const size_t end_b = lineOffset(file_b, last);
+    int64_t line_diffs = 0;
+    for (int64_t i = first; i < last;) {
+        size_t ia = offset_a;
+        size_t ib = offset_b;
+        for (;;) {
+            const size_t m = findMismatch(a + ia, b + ib, std::min(end_a - ia, end_b - ib));
+            ia += m;
+            ib += m;
+            if constexpr (Endings != LineEndings::IGNORED) {
+                break;
+            } else if (ia + 1 < end_a && ib < end_b && a[ia] == '\r' && a[ia + 1] == '\n' && b[ib] == '\n') {
+                ++ia;
+            } else if (ib + 1 < end_b && ia < end_a && b[ib] == '\r' && b[ib + 1] == '\n' && a[ia] == '\n') {
+                ++ib;
+            } else {
+                break;
+            }
+        }
+        if (ia == end_a && ib == end_b)
+            break;
+
+        // Back up to the start of the line in each file. The bytes before it
+        // matched, so both files are on the same line.
+        const size_t start_a = offset_a + lineStart(a + offset_a, ia - offset_a);
+        const size_t start_b = offset_b + lineStart(b + offset_b, ib - offset_b);
+        i += scanLines(a + offset_a, start_a - offset_a).lf_count;
+        if (i >= last)
+            break;
+        offset_a = start_a;
+        offset_b = start_b;
+
+        // Differences come in runs, so go on line by line until a line matches again.
+        bool different = false;
+        do {
+            const std::string_view line_a = file_a.getLine(offset_a);
+            const std::string_view line_b = file_b.getLine(offset_b);
+            different = linesDiffer<Endings, false>(file_a, file_b, line_a, line_b, options.normalization);
+            if (different) {
+                ++line_diffs;
+                if (!emitLineDiff(file_a, file_b, i, line_a, line_b, options, emit))
+                    return line_diffs;
+            }
+            ++i;
+        } while (different && i < last);
+    }
+    return line_diffs;
+}
+
+// @brief Compare lines [first, last) starting at the given byte offsets.
+//        The loop for the line endings and the normalization of the comparison
+//        is picked once, so the per line checks that don't apply are compiled
+//        out. Each differing line is passed to emit. Stops when emit returns
+//        false. Returns the number of differing lines.
+template<typename Emit>
+int64_t
+compareRange(const File& file_a, const File& file_b, int64_t first, int64_t last, size_t offset_a, size_t offset_b, const CompareOptions& options, Emit&& emit)
+{
+    const bool normalized = options.normalization.any();
+    switch (getLineEndings(file_a, file_b, options)) {
+        case LineEndings::SAME:
+            return normalized ? compareNormalizedRange<LineEndings::SAME>(file_a, file_b, first, last, offset_a, offset_b, options, emit)
+                              : compareRawRange<LineEndings::SAME>(file_a, file_b, first, last, offset_a, offset_b, options, emit);
+        case LineEndings::COMPARED:
+            return normalized ? compareNormalizedRange<LineEndings::COMPARED>(file_a, file_b, first, last, offset_a, offset_b, options, emit)
+                              : compareRawRange<LineEndings::COMPARED>(file_a, file_b, first, last, offset_a, offset_b, options, emit);
+        case LineEndings::IGNORED:
+            return normalized ? compareNormalizedRange<LineEndings::IGNORED>(file_a, file_b, first, last, offset_a, offset_b, options, emit)
+                              : compareRawRange<LineEndings::IGNORED>(file_a, file_b, first, last, offset_a, offset_b, options, emit);
+    }
+    return 0;
+}
+
+// The lines and results of one chunk of a parallel comparison.
+struct Chunk
+{
+    int64_t first = 0;
+    int64_t last = 0;
+    std::vector<LineDiff> diffs;
+    bool done = false;
+};
+
+} // namespace
+
+// @brief Check whether any line of file a may end differently from the same line of file b.
+bool
+lineEndingsDiffer(const File& file_a, const File& file_b)
+{
+    return file_a.hasMixedLineEndings() || file_b.hasMixedLineEndings() || file_a.getLineEnding() != file_b.getLineEnding();
+}
+
+// @brief Find the first line where the two files differ.
+//        Files with equal cached digests are identical without looking at them.
+//        Equal prefixes are skipped with the block mismatch kernel. When line
+//        endings are ignored, a CR that only one side has in front of a LF is
+//        stepped over and the search continues. A search that starts at a later
+//        line only counts the lines from there.
+MatchPoint
+findFirstDifference(const File& file_a, const File& file_b, bool le_ignore, const MatchPoint& from)
+{
+    MatchPoint point;
+    // Equal digests from the scan cache settle it without reading either file.
+    if (file_a.sameDigest(file_b)) {
+        point.identical = true;
+        return point;
+    }
+
+    const char* a = file_a.getData();
+    const char* b = file_b.getData();
+    const size_t size_a = file_a.getSize();
+    const size_t size_b = file_b.getSize();
+    ScopedPhase phase(StatPhase::FIRST_DIFFERENCE);
+
+    size_t ia = from.offset_a;
+    size_t ib = from.offset_b;
+    for (;;) {
+        const size_t n = std::min(size_a - ia, size_b - ib);
+        const size_t m = findMismatch(a + ia, b + ib, n);
+        ia += m;
+        ib += m;
+        if (!le_ignore)
+            break;
+        // Step over a CRLF on one side that faces a LF on the other.
+        if (ia + 1 < size_a && ib < size_b && a[ia] == '\r' && a[ia + 1] == '\n' && b[ib] == '\n')
+            ++ia;
+        else if (ib + 1 < size_b && ia < size_a && b[ib] == '\r' && b[ib + 1] == '\n' && a[ia] == '\n')
+            ++ib;
+        else
+            break;
+    }
+    phase.addBytes((ia - from.offset_a) + (ib - from.offset_b));
+
+    if (ia == size_a && ib == size_b) {
+        point.identical = true;
+        return point;
+    }
+
+    // Back up to the beginning of the line in each file.
+    // The prefixes matched, so both files are on the same line.
+    point.offset_a = lineStart(a, ia);
+    point.offset_b = lineStart(b, ib);
+    point.line = from.line + scanLines(a + from.offset_a, point.offset_a - from.offset_a).lf_count;
+    return point;
+}
+
+std::string
+formatLineDiff(const LineDiff& diff, int64_t number)
+{
+    std::string text;
+    appendLineDiff(text, diff, number);
+    return text;
+}
+
+// @brief Append the "@@" record of a differing line to out.
+//        Appending lets a caller reuse one large buffer for many records.
+void
+appendLineDiff(std::string& out, const LineDiff& diff, int64_t number)
+{
+    out += "@@ ";
+    out += std::to_string(number);
+    out += ", line ";
+    out += std::to_string(diff.line + 1);
+    out += "\nFile a: ";
+    out += diff.line_a;
+    out += diff.pretty_le_a;
+    out += "\nFile b: ";
+    out += diff.line_b;
+    out += diff.pretty_le_b;
+    out += "\n\n";
+}
+
+// @brief Compare the lines of both files, serially or in parallel chunks.
+//        Chunks start on line boundaries that are found with File::findLine(), so
+//        both files are split at the same line numbers. Results are handed to the
+//        handler in chunk order as soon as each chunk is done.
+int64_t
+compareLines(const File& file_a, const File& file_b, const MatchPoint& start, int64_t last_line, const CompareOptions& options, const DiffHandler& handler)
+{
+    const int64_t first_line = start.line;
+    const int64_t lines = last_line - first_line;
+    if (lines <= 0)
+        return 0;
+    ScopedPhase phase(StatPhase::COMPARE);
+    phase.addLines(static_cast<uint64_t>(lines));
+
+    if (options.jobs <= 1 || lines < 2 * min_chunk_lines) {
+        return compareRange(file_a, file_b, first_line, last_line, start.offset_a, start.offset_b, options,
+                            [&handler](LineDiff&& diff) { return handler(diff); });
+    }
+
+    const int64_t chunk_count_goal = static_cast<int64_t>(options.jobs) * chunks_per_job;
+    const int64_t chunk_lines = std::max(min_chunk_lines, (lines + chunk_count_goal - 1) / chunk_count_goal);
+    std::vector<Chunk> chunks((lines + chunk_lines - 1) / chunk_lines);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        chunks[c].first = first_line + static_cast<int64_t>(c) * chunk_lines;
+        chunks[c].last = std::min(chunks[c].first + chunk_lines, last_line);
+    }
+
+    std::mutex mutex;
+    std::condition_variable chunk_done;
+    // Set when the handler stops the comparison; running chunks then give up early.
+    std::atomic<bool> stopped(false);
+    ThreadPool pool(options.jobs);
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        pool.submit([&, c] {
+            Chunk& chunk = chunks[c];
+            const size_t offset_a = (c == 0) ? start.offset_a : file_a.findLine(chunk.first);
+            const size_t offset_b = (c == 0) ? start.offset_b : file_b.findLine(chunk.first);
+            std::vector<LineDiff> diffs;
+            compareRange(file_a, file_b, chunk.first, chunk.last, offset_a, offset_b, options,
+                         [&diffs, &stopped](LineDiff&& diff) {
+                             diffs.push_back(std::move(diff));
+                             return !stopped.load(std::memory_order_relaxed);
+                         });
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunk.diffs = std::move(diffs);
+                chunk.done = true;
+            }
+            chunk_done.notify_all();
+        });
+    }
+
+    // Hand over the results in order while the later chunks are still running.
+    int64_t line_diffs = 0;
+    for (auto& chunk : chunks) {
+        std::vector<LineDiff> diffs;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            chunk_done.wait(lock, [&chunk] { return chunk.done; });
+            diffs = std::move(chunk.diffs);
+        }
+        for (const auto& diff : diffs) {
+            ++line_diffs;
+            if (!handler(diff)) {
+                stopped = true;
+                break;
+            }
+        }
+        if (stopped)
+            break;
+    }
+    pool.wait();
+    return line_diffs;
+}
+
+namespace {
+
+// @brief Compare the lines of two streams up to the end of the shorter one.
+//        Streams can't know up front whether they mix line endings, so unless
+//        line endings are ignored, the ending of each line is compared as it comes.
+template<bool CompareLe, bool Normalized>
+void
+compareStreamLines(StreamReader& stream_a, StreamReader& stream_b, const CompareOptions& options, const DiffHandler& handler, StreamCompareResult& result)
+{
+    std::string_view line_a;
+    std::string_view line_b;
+    for (;;) {
+        const bool has_a = stream_a.nextLine(line_a);
+        const bool has_b = stream_b.nextLine(line_b);
+        if (!has_a || !has_b)
+            break;
+        bool le_differ = false;
+        if constexpr (CompareLe)
+            le_differ = stream_a.getPrettyLE() != stream_b.getPrettyLE();
+        bool different = le_differ;
+        if constexpr (Normalized)
+            different = different || !equalNormalized(line_a, line_b, options.normalization);
+        else
+            different = different || line_a != line_b;
+        if (different) {
+            LineDiff diff;
+            diff.line = result.compared;
+            if (options.keep_lines) {
+                diff.line_a = line_a;
+                diff.line_b = line_b;
+                if (options.with_pretty_le || le_differ) {
+                    diff.pretty_le_a = stream_a.getPrettyLE();
+                    diff.pretty_le_b = stream_b.getPrettyLE();
+                }
+                diff.no_newline_a = !stream_a.endsInNewline();
+                diff.no_newline_b = !stream_b.endsInNewline();
+                diff.crlf_a = !diff.no_newline_a && stream_a.endsInCrlf();
+                diff.crlf_b = !diff.no_newline_b && stream_b.endsInCrlf();
+            }
+            ++result.line_diffs;
+            if (!handler(diff)) {
+                result.stopped = true;
+                break;
+            }
+        }
+        ++result.compared;
+    }
+}
+
+} // namespace
+
+// @brief Compare two streams line by line.
+//        Only the current line of each stream is looked at, so memory stays at
+//        the read-ahead buffers no matter how long the streams are. The loop for
+//        the line endings and normalization of the comparison is picked once.
+StreamCompareResult
+compareStreams(StreamReader& stream_a, StreamReader& stream_b, bool stop_at_shorter, const CompareOptions& options, const DiffHandler& handler)
+{
+    ScopedPhase phase(StatPhase::COMPARE);
+    StreamCompareResult result;
+    const bool compare_le = !options.le_ignore;
+    const bool normalized = options.normalization.any();
+    if (compare_le && normalized)
+        compareStreamLines<true, true>(stream_a, stream_b, options, handler, result);
+    else if (compare_le)
+        compareStreamLines<true, false>(stream_a, stream_b, options, handler, result);
+    else if (normalized)
+        compareStreamLines<false, true>(stream_a, stream_b, options, handler, result);
+    else
+        compareStreamLines<false, false>(stream_a, stream_b, options, handler, result);
+
+    if (!stop_at_shorter && !result.stopped) {
+        std::string_view line;
+        while (stream_a.nextLine(line)) {
+        }
+        while (stream_b.nextLine(line)) {
+        }
+    }
+    phase.addLines(static_cast<uint64_t>(result.compared));
+    return result;
+}
+
+} // namespace AbeCmp
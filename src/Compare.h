@@ -0,0 +1,121 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "File.h"
+#include "Normalize.h"
+#include "StreamReader.h"
+
+// System includes.
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace AbeCmp {
+
+// Where two files stop being byte for byte equal.
+struct MatchPoint
+{
+    // True when the files are equal as a whole.
+    bool identical = false;
+    // Byte offsets of the first line that may differ, in each file.
+    size_t offset_a = 0;
+    size_t offset_b = 0;
+    // Zero based index of that line (the same in both files).
+    int64_t line = 0;
+};
+
+// True unless every line of both files ends the same way, i.e. the files use
+// different line endings or either of them mixes LF and CRLF.
+bool lineEndingsDiffer(const File& file_a, const File& file_b);
+
+// Compare the raw bytes of both files in large blocks to find the first line that differs.
+// With le_ignore, a CRLF in one file matches a LF in the other. The search starts
+// at from, which must be the start of the same line in both files.
+MatchPoint findFirstDifference(const File& file_a, const File& file_b, bool le_ignore, const MatchPoint& from = MatchPoint());
+
+// A line that differs between the two files.
+struct LineDiff
+{
+    // Zero based index of the line.
+    int64_t line = 0;
+    // The text of each line, without its line ending.
+    std::string line_a;
+    std::string line_b;
+    // The pretty line ending shown after each line, empty unless they are shown.
+    const char* pretty_le_a = "";
+    const char* pretty_le_b = "";
+    // True if a line ends in a CRLF (unified output writes the raw line ending).
+    bool crlf_a = false;
+    bool crlf_b = false;
+    // True if a line is the last line of its file and has no line ending.
+    bool no_newline_a = false;
+    bool no_newline_b = false;
+};
+
+// How to compare the lines of two files.
+struct CompareOptions
+{
+    // Lines that only differ in their line endings (LF vs CRLF) match.
+    // Otherwise the line ending of each line is compared along with its text.
+    bool le_ignore = false;
+    // Show each differing line with its pretty line ending.
+    bool with_pretty_le = false;
+    // Keep the text of the differing lines (not needed for quiet output).
+    bool keep_lines = true;
+    // The number of threads to compare with.
+    unsigned jobs = 1;
+    // Differences between lines that don't count.
+    Normalization normalization;
+};
+
+// Format a differing line as an "@@" record with the text of both lines.
+std::string formatLineDiff(const LineDiff& diff, int64_t number);
+// Append the "@@" record of a differing line to out.
+void appendLineDiff(std::string& out, const LineDiff& diff, int64_t number);
+
+// Receives each differing line, in file order, on the calling thread.
+// Returns false to stop the comparison.
+using DiffHandler = std::function<bool(const LineDiff& diff)>;
+
+// Compare the lines of both files from start up to (not including) last_line.
+// With more than one job, the lines are split into chunks that are compared on a
+// thread pool and handed to the handler in order. Returns the number of differing
+// lines that were handed to the handler.
+int64_t compareLines(const File& file_a, const File& file_b, const MatchPoint& start, int64_t last_line, const CompareOptions& options, const DiffHandler& handler);
+
+// The outcome of comparing two streams.
+struct StreamCompareResult
+{
+    // The number of differing lines.
+    int64_t line_diffs = 0;
+    // The number of lines that were compared (both streams had them).
+    int64_t compared = 0;
+    // True if the handler stopped the comparison.
+    bool stopped = false;
+};
+
+// Compare two streams line by line while their read-ahead threads keep reading.
+// Streams are read once, so line counts are only known at the end: unless
+// stop_at_shorter is set, the longer stream is read to its end so both readers
+// report their full line count. A stopped comparison doesn't read any further.
+StreamCompareResult compareStreams(StreamReader& stream_a, StreamReader& stream_b, bool stop_at_shorter, const CompareOptions& options, const DiffHandler& handler);
+
+} // namespace AbeCmp
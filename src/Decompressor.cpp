@@ -0,0 +1,276 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Project includes.
+#include "Decompressor.h"
+
+// System includes.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#if defined(ABECMP_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+#if defined(ABECMP_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace AbeCmp {
+
+namespace {
+
+const char* const compression_names[] = { "none", "gzip", "zstd" };
+
+const unsigned char gzip_magic[] = { 0x1f, 0x8b };
+const unsigned char zstd_magic[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+// Grow the output of decompressAll() by at least this much at a time.
+const size_t decompress_chunk_size = 4 << 20;
+
+// @brief True if data starts with the magic bytes.
+template<size_t N>
+bool
+hasMagic(const char* data, size_t size, const unsigned char (&magic)[N])
+{
+    return size >= N && std::memcmp(data, magic, N) == 0;
+}
+
+} // namespace
+
+Compression
+detectCompression(const char* data, size_t size)
+{
+    if (hasMagic(data, size, gzip_magic))
+        return Compression::GZIP;
+    if (hasMagic(data, size, zstd_magic))
+        return Compression::ZSTD;
+    return Compression::NONE;
+}
+
+// @brief Detect the compression of a file from its first bytes.
+Compression
+detectFileCompression(const std::string& name)
+{
+    if (name == "-")
+        return Compression::NONE;
+    std::ifstream file(name, std::ios::in | std::ios::binary);
+    char magic[sizeof(zstd_magic)] = {};
+    file.read(magic, sizeof(magic));
+    return detectCompression(magic, static_cast<size_t>(file.gcount()));
+}
+
+const char*
+getCompressionName(Compression compression)
+{
+    return compression_names[static_cast<int>(compression)];
+}
+
+bool
+isCompressionSupported(Compression compression)
+{
+    switch (compression) {
+        case Compression::NONE:
+            return true;
+        case Compression::GZIP:
+#if defined(ABECMP_HAVE_ZLIB)
+            return true;
+#else
+            return false;
+#endif
+        case Compression::ZSTD:
+#if defined(ABECMP_HAVE_ZSTD)
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+Decompressor::~Decompressor()
+{
+    close();
+}
+
+// @brief Start a new stream of the given format.
+bool
+Decompressor::init(Compression compression)
+{
+    close();
+    switch (compression) {
+        case Compression::NONE:
+            return false;
+        case Compression::GZIP: {
+#if defined(ABECMP_HAVE_ZLIB)
+            z_stream* stream = new z_stream();
+            // 16 + MAX_WBITS reads a gzip header instead of a zlib one.
+            if (inflateInit2(stream, 16 + MAX_WBITS) != Z_OK) {
+                delete stream;
+                return false;
+            }
+            m_state = stream;
+            break;
+#else
+            return false;
+#endif
+        }
+        case Compression::ZSTD: {
+#if defined(ABECMP_HAVE_ZSTD)
+            ZSTD_DStream* stream = ZSTD_createDStream();
+            if (stream == nullptr)
+                return false;
+            ZSTD_initDStream(stream);
+            m_state = stream;
+            break;
+#else
+            return false;
+#endif
+        }
+    }
+    m_compression = compression;
+    m_finished = false;
+    return true;
+}
+
+void
+Decompressor::close()
+{
+    if (m_state != nullptr) {
+#if defined(ABECMP_HAVE_ZLIB)
+        if (m_compression == Compression::GZIP) {
+            z_stream* stream = static_cast<z_stream*>(m_state);
+            inflateEnd(stream);
+            delete stream;
+        }
+#endif
+#if defined(ABECMP_HAVE_ZSTD)
+        if (m_compression == Compression::ZSTD)
+            ZSTD_freeDStream(static_cast<ZSTD_DStream*>(m_state));
+#endif
+    }
+    m_state = nullptr;
+    m_compression = Compression::NONE;
+    m_finished = true;
+}
+
+// @brief Decompress as much of the input as fits in out.
+//        Output that is still held back from earlier input is written out first,
+//        so call again with no input left until nothing more is produced. A
+//        stream that ends with input left over starts over on the next gzip
+//        member or zstd frame.
+bool
+Decompressor::decompress(const char*& in, size_t& in_size, char* out, size_t out_size, size_t& produced)
+{
+    produced = 0;
+    if (m_state == nullptr)
+        return false;
+
+#if defined(ABECMP_HAVE_ZLIB)
+    if (m_compression == Compression::GZIP) {
+        z_stream* stream = static_cast<z_stream*>(m_state);
+        while (produced < out_size && !(m_finished && in_size == 0)) {
+            // Reset only once the next member has started, so the end of the
+            // input after a member is a clean end.
+            if (m_finished) {
+                if (inflateReset(stream) != Z_OK)
+                    return false;
+                m_finished = false;
+            }
+            // zlib counts in uInt, so hand over at most 1 GiB at a time.
+            const size_t in_part = std::min<size_t>(in_size, 1u << 30);
+            const size_t out_part = std::min<size_t>(out_size - produced, 1u << 30);
+            stream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in));
+            stream->avail_in = static_cast<uInt>(in_part);
+            stream->next_out = reinterpret_cast<Bytef*>(out + produced);
+            stream->avail_out = static_cast<uInt>(out_part);
+            const int result = inflate(stream, Z_NO_FLUSH);
+            const size_t used = in_part - stream->avail_in;
+            const size_t written = out_part - stream->avail_out;
+            in += used;
+            in_size -= used;
+            produced += written;
+            if (result == Z_STREAM_END)
+                m_finished = true;
+            else if (result != Z_OK && result != Z_BUF_ERROR)
+                return false;
+            // No progress: the input ran out in the middle of the member.
+            if (used == 0 && written == 0 && result != Z_STREAM_END)
+                break;
+        }
+        return true;
+    }
+#endif
+#if defined(ABECMP_HAVE_ZSTD)
+    if (m_compression == Compression::ZSTD) {
+        ZSTD_DStream* stream = static_cast<ZSTD_DStream*>(m_state);
+        ZSTD_inBuffer input = { in, in_size, 0 };
+        ZSTD_outBuffer output = { out, out_size, 0 };
+        while (output.pos < output.size) {
+            const size_t in_before = input.pos;
+            const size_t out_before = output.pos;
+            const size_t result = ZSTD_decompressStream(stream, &output, &input);
+            if (ZSTD_isError(result))
+                return false;
+            // No progress: everything that can be produced from the input so far is out.
+            if (input.pos == in_before && output.pos == out_before)
+                break;
+            // A result of 0 means a frame has just been completed and flushed.
+            m_finished = (result == 0);
+            if (input.pos == input.size && output.pos < output.size)
+                break;
+        }
+        in += input.pos;
+        in_size -= input.pos;
+        produced = output.pos;
+        return true;
+    }
+#endif
+    (void)in;
+    (void)in_size;
+    (void)out;
+    (void)out_size;
+    return false;
+}
+
+// @brief Decompress all of the data, growing out as the output comes.
+bool
+decompressAll(Compression compression, const char* data, size_t size, std::vector<char>& out)
+{
+    Decompressor decompressor;
+    if (!decompressor.init(compression))
+        return false;
+    out.clear();
+    size_t used = 0;
+    for (;;) {
+        // Compressed text usually expands a few times over.
+        if (out.size() - used < decompress_chunk_size)
+            out.resize(used + std::max(decompress_chunk_size, 2 * size));
+        const size_t size_before = size;
+        size_t produced = 0;
+        if (!decompressor.decompress(data, size, out.data() + used, out.size() - used, produced))
+            return false;
+        used += produced;
+        if (produced == 0 && size == size_before)
+            break;
+    }
+    out.resize(used);
+    return size == 0 && decompressor.isFinished();
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,76 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// System includes.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace AbeCmp {
+
+// The compressed formats that are read transparently.
+enum class Compression
+{
+    NONE,
+    GZIP,
+    ZSTD
+};
+
+// Detect the compression from the magic bytes at the start of the data.
+Compression detectCompression(const char* data, size_t size);
+// Detect the compression of a regular file from its first bytes. Stdin and
+// files that can't be read are taken to be uncompressed.
+Compression detectFileCompression(const std::string& name);
+// The name of a compression, like "gzip".
+const char* getCompressionName(Compression compression);
+// True if this build can decompress the format (zlib and zstd are optional).
+bool isCompressionSupported(Compression compression);
+
+// Decompresses a gzip or zstd stream piece by piece, so the caller decides how
+// much input and output is held at once. Concatenated gzip members and zstd
+// frames are read as one stream, like gzip -d and zstd -d do.
+class Decompressor
+{
+  public:
+    Decompressor() = default;
+    ~Decompressor();
+    Decompressor(const Decompressor&) = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    // Start a new stream. Fails if the format isn't supported.
+    bool init(Compression compression);
+    // Free the decompression state.
+    void close();
+    // Decompress from the input into out, up to out_size bytes. The input is
+    // advanced past the bytes that were used. Returns false on corrupt data.
+    bool decompress(const char*& in, size_t& in_size, char* out, size_t out_size, size_t& produced);
+    // True if the last stream (member or frame) ended, so the input may end here.
+    bool isFinished() const { return m_finished; }
+
+  private:
+    Compression m_compression = Compression::NONE;
+    // A z_stream or a ZSTD_DStream, so the library headers stay out of this one.
+    void* m_state = nullptr;
+    bool m_finished = true;
+};
+
+// Decompress all of the data into out. Returns false on corrupt or truncated data.
+bool decompressAll(Compression compression, const char* data, size_t size, std::vector<char>& out);
+
+} // namespace AbeCmp
@@ -0,0 +1,712 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "Diff.h"
+#include "LineIterator.h"
+#include "Stats.h"
+
+// System includes.
+#include <algorithm>
+#include <climits>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace AbeCmp {
+
+namespace {
+
+// Histogram diff skips lines that occur more often than this in file a.
+const long max_histogram_chain = 64;
+// Myers gives up on finding the optimal split after this many edit steps, at the least.
+const long min_too_expensive = 256;
+// Folded into the id of a CRLF line, so it never matches a LF line.
+const uint64_t crlf_salt = 0x9e3779b97f4a7c15ull;
+
+// A range of lines to diff, a[xoff, xlim) against b[yoff, ylim).
+struct Range
+{
+    long xoff = 0;
+    long xlim = 0;
+    long yoff = 0;
+    long ylim = 0;
+    DiffAlgorithm algorithm = DiffAlgorithm::MYERS;
+};
+
+// Marks the lines of both sequences that are not part of the common subsequence.
+// The line ids must be dense (less than id_count), so per id tables can be flat arrays.
+// Ranges are processed from an explicit work stack, so deep splits can't overflow the call stack.
+class Differ
+{
+  public:
+    Differ(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, size_t id_count);
+    // Diff the whole sequences, starting with the given algorithm.
+    void run(DiffAlgorithm algorithm);
+    bool isChangedA(long x) const { return m_changed_a[x] != 0; }
+    bool isChangedB(long y) const { return m_changed_b[y] != 0; }
+
+  private:
+    // Strip equal lines off both ends of the range. Returns false if nothing is left to split.
+    bool trim(Range& r);
+    // Split the range at the middle snake of the shortest edit script.
+    void myers(const Range& r, std::vector<Range>& work);
+    // Split the range at the longest run of lines unique to both sides.
+    void patience(const Range& r, std::vector<Range>& work);
+    // Split the range at the longest match through the least frequent line.
+    void histogram(const Range& r, std::vector<Range>& work);
+    // Find the middle snake of a range, or a good enough split point when it gets too expensive.
+    std::pair<long, long> split(const Range& r);
+
+  private:
+    const uint32_t* m_a;
+    const uint32_t* m_b;
+    long m_n;
+    long m_m;
+    std::vector<char> m_changed_a;
+    std::vector<char> m_changed_b;
+    // Furthest reaching forward and backward paths, indexed by diagonal.
+    std::vector<long> m_fd_buf;
+    std::vector<long> m_bd_buf;
+    long* m_fd;
+    long* m_bd;
+    long m_too_expensive = min_too_expensive;
+    // Per id scratch tables for patience and histogram, all zero between ranges.
+    std::vector<long> m_count_a;
+    std::vector<long> m_count_b;
+    std::vector<long> m_last_a;
+    // Previous position of the same id in file a, for the histogram chains.
+    std::vector<long> m_prev_a;
+};
+
+Differ::Differ(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, size_t id_count)
+  : m_a(a.data())
+  , m_b(b.data())
+  , m_n(static_cast<long>(a.size()))
+  , m_m(static_cast<long>(b.size()))
+  , m_changed_a(a.size(), 0)
+  , m_changed_b(b.size(), 0)
+  , m_fd_buf(a.size() + b.size() + 3)
+  , m_bd_buf(a.size() + b.size() + 3)
+  , m_count_a(id_count, 0)
+  , m_count_b(id_count, 0)
+  , m_last_a(id_count, 0)
+  , m_prev_a(a.size(), 0)
+{
+    // Diagonals run from -(m + 1) to n + 1.
+    m_fd = m_fd_buf.data() + m_m + 1;
+    m_bd = m_bd_buf.data() + m_m + 1;
+    // Roughly the square root of the number of diagonals, like GNU diff.
+    long too_expensive = 1;
+    for (long diags = m_n + m_m + 3; diags != 0; diags >>= 2)
+        too_expensive <<= 1;
+    m_too_expensive = std::max(min_too_expensive, too_expensive);
+}
+
+void
+Differ::run(DiffAlgorithm algorithm)
+{
+    std::vector<Range> work;
+    work.push_back({ 0, m_n, 0, m_m, algorithm });
+    while (!work.empty()) {
+        Range r = work.back();
+        work.pop_back();
+        if (!trim(r))
+            continue;
+        switch (r.algorithm) {
+            case DiffAlgorithm::PATIENCE:
+                patience(r, work);
+                break;
+            case DiffAlgorithm::HISTOGRAM:
+                histogram(r, work);
+                break;
+            default:
+                myers(r, work);
+                break;
+        }
+    }
+}
+
+bool
+Differ::trim(Range& r)
+{
+    while (r.xoff < r.xlim && r.yoff < r.ylim && m_a[r.xoff] == m_b[r.yoff]) {
+        ++r.xoff;
+        ++r.yoff;
+    }
+    while (r.xoff < r.xlim && r.yoff < r.ylim && m_a[r.xlim - 1] == m_b[r.ylim - 1]) {
+        --r.xlim;
+        --r.ylim;
+    }
+    // Whatever is left on one side only was inserted or deleted.
+    if (r.xoff == r.xlim) {
+        std::fill(m_changed_b.begin() + r.yoff, m_changed_b.begin() + r.ylim, 1);
+        return false;
+    }
+    if (r.yoff == r.ylim) {
+        std::fill(m_changed_a.begin() + r.xoff, m_changed_a.begin() + r.xlim, 1);
+        return false;
+    }
+    return true;
+}
+
+void
+Differ::myers(const Range& r, std::vector<Range>& work)
+{
+    const auto [xmid, ymid] = split(r);
+    if ((xmid == r.xoff && ymid == r.yoff) || (xmid == r.xlim && ymid == r.ylim)) {
+        // No progress, so mark the whole range as changed.
+        std::fill(m_changed_a.begin() + r.xoff, m_changed_a.begin() + r.xlim, 1);
+        std::fill(m_changed_b.begin() + r.yoff, m_changed_b.begin() + r.ylim, 1);
+        return;
+    }
+    work.push_back({ xmid, r.xlim, ymid, r.ylim, DiffAlgorithm::MYERS });
+    work.push_back({ r.xoff, xmid, r.yoff, ymid, DiffAlgorithm::MYERS });
+}
+
+// @brief Find the midpoint of the shortest edit script for a range by running the
+//        forward and backward searches at the same time until they overlap
+//        (Myers 1986, section 4b). Once the edit cost passes m_too_expensive,
+//        settle for the diagonal that got furthest, so the runtime stays bounded.
+std::pair<long, long>
+Differ::split(const Range& r)
+{
+    const long xoff = r.xoff, xlim = r.xlim, yoff = r.yoff, ylim = r.ylim;
+    const long dmin = xoff - ylim;
+    const long dmax = xlim - yoff;
+    const long fmid = xoff - yoff;
+    const long bmid = xlim - ylim;
+    long fmin = fmid, fmax = fmid;
+    long bmin = bmid, bmax = bmid;
+    const bool odd = (fmid - bmid) & 1;
+
+    m_fd[fmid] = xoff;
+    m_bd[bmid] = xlim;
+    for (long c = 1;; ++c) {
+        // Extend the forward search by one edit.
+        if (fmin > dmin)
+            m_fd[--fmin - 1] = -1;
+        else
+            ++fmin;
+        if (fmax < dmax)
+            m_fd[++fmax + 1] = -1;
+        else
+            --fmax;
+        for (long d = fmax; d >= fmin; d -= 2) {
+            const long tlo = m_fd[d - 1];
+            const long thi = m_fd[d + 1];
+            long x = (tlo >= thi) ? tlo + 1 : thi;
+            long y = x - d;
+            while (x < xlim && y < ylim && m_a[x] == m_b[y]) {
+                ++x;
+                ++y;
+            }
+            m_fd[d] = x;
+            if (odd && bmin <= d && d <= bmax && m_bd[d] <= x)
+                return { x, y };
+        }
+
+        // Extend the backward search by one edit.
+        if (bmin > dmin)
+            m_bd[--bmin - 1] = LONG_MAX;
+        else
+            ++bmin;
+        if (bmax < dmax)
+            m_bd[++bmax + 1] = LONG_MAX;
+        else
+            --bmax;
+        for (long d = bmax; d >= bmin; d -= 2) {
+            const long tlo = m_bd[d - 1];
+            const long thi = m_bd[d + 1];
+            long x = (tlo < thi) ? tlo : thi - 1;
+            long y = x - d;
+            while (x > xoff && y > yoff && m_a[x - 1] == m_b[y - 1]) {
+                --x;
+                --y;
+            }
+            m_bd[d] = x;
+            if (!odd && fmin <= d && d <= fmax && x <= m_fd[d])
+                return { x, y };
+        }
+
+        if (c < m_too_expensive)
+            continue;
+
+        // Too expensive: take the furthest reaching forward or backward diagonal.
+        long fxybest = -1, fxbest = xoff;
+        for (long d = fmax; d >= fmin; d -= 2) {
+            long x = std::min(m_fd[d], xlim);
+            long y = x - d;
+            if (ylim < y) {
+                x = ylim + d;
+                y = ylim;
+            }
+            if (fxybest < x + y) {
+                fxybest = x + y;
+                fxbest = x;
+            }
+        }
+        long bxybest = LONG_MAX, bxbest = xlim;
+        for (long d = bmax; d >= bmin; d -= 2) {
+            long x = std::max(xoff, m_bd[d]);
+            long y = x - d;
+            if (y < yoff) {
+                x = yoff + d;
+                y = yoff;
+            }
+            if (x + y < bxybest) {
+                bxybest = x + y;
+                bxbest = x;
+            }
+        }
+        if ((xlim + ylim) - bxybest < fxybest - (xoff + yoff))
+            return { fxbest, fxybest - fxbest };
+        return { bxbest, bxybest - bxbest };
+    }
+}
+
+// @brief Patience diff: pair up the lines that occur exactly once on each side,
+//        keep the longest increasing run of those pairs as anchors and diff the
+//        gaps between them. Falls back to Myers when there are no anchors.
+void
+Differ::patience(const Range& r, std::vector<Range>& work)
+{
+    for (long x = r.xoff; x < r.xlim; ++x) {
+        ++m_count_a[m_a[x]];
+        m_last_a[m_a[x]] = x;
+    }
+    for (long y = r.yoff; y < r.ylim; ++y)
+        ++m_count_b[m_b[y]];
+
+    // Unique pairs in file b order.
+    std::vector<std::pair<long, long>> pairs;
+    for (long y = r.yoff; y < r.ylim; ++y) {
+        const uint32_t id = m_b[y];
+        if (m_count_a[id] == 1 && m_count_b[id] == 1)
+            pairs.push_back({ m_last_a[id], y });
+    }
+    // Leave the tables zeroed for the next range.
+    for (long x = r.xoff; x < r.xlim; ++x)
+        m_count_a[m_a[x]] = 0;
+    for (long y = r.yoff; y < r.ylim; ++y)
+        m_count_b[m_b[y]] = 0;
+    if (pairs.empty()) {
+        work.push_back({ r.xoff, r.xlim, r.yoff, r.ylim, DiffAlgorithm::MYERS });
+        return;
+    }
+
+    // Longest increasing subsequence of the file a positions, by patience sorting.
+    std::vector<size_t> tails;
+    std::vector<long> prev(pairs.size(), -1);
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        const auto pos = std::lower_bound(tails.begin(), tails.end(), pairs[i].first,
+                                          [&pairs](size_t t, long x) { return pairs[t].first < x; });
+        if (pos != tails.begin())
+            prev[i] = static_cast<long>(*(pos - 1));
+        if (pos == tails.end())
+            tails.push_back(i);
+        else
+            *pos = i;
+    }
+    std::vector<std::pair<long, long>> anchors;
+    for (long i = static_cast<long>(tails.back()); i >= 0; i = prev[i])
+        anchors.push_back(pairs[i]);
+    std::reverse(anchors.begin(), anchors.end());
+
+    long x = r.xoff, y = r.yoff;
+    for (const auto& anchor : anchors) {
+        work.push_back({ x, anchor.first, y, anchor.second, DiffAlgorithm::PATIENCE });
+        x = anchor.first + 1;
+        y = anchor.second + 1;
+    }
+    work.push_back({ x, r.xlim, y, r.ylim, DiffAlgorithm::PATIENCE });
+}
+
+// @brief Histogram diff: find the longest common run that goes through the line
+//        with the fewest occurrences in file a and diff what's left on either side.
+//        Lines that occur too often are never used as anchors. Falls back to Myers
+//        when no anchor is found.
+void
+Differ::histogram(const Range& r, std::vector<Range>& work)
+{
+    // Chain the positions of each id in file a, most recent first.
+    for (long x = r.xoff; x < r.xlim; ++x) {
+        const uint32_t id = m_a[x];
+        m_prev_a[x] = (m_count_a[id]++ > 0) ? m_last_a[id] : -1;
+        m_last_a[id] = x;
+    }
+
+    long best_count = max_histogram_chain + 1;
+    long best_len = 0, best_x = 0, best_y = 0;
+    for (long y = r.yoff; y < r.ylim;) {
+        const long count = m_count_a[m_b[y]];
+        if (count == 0 || count > max_histogram_chain || count > best_count) {
+            ++y;
+            continue;
+        }
+        long next_y = y + 1;
+        for (long x = m_last_a[m_b[y]]; x >= 0; x = m_prev_a[x]) {
+            long sx = x, sy = y;
+            while (sx > r.xoff && sy > r.yoff && m_a[sx - 1] == m_b[sy - 1]) {
+                --sx;
+                --sy;
+            }
+            long ex = x + 1, ey = y + 1;
+            while (ex < r.xlim && ey < r.ylim && m_a[ex] == m_b[ey]) {
+                ++ex;
+                ++ey;
+            }
+            if (count < best_count || ex - sx > best_len) {
+                best_count = count;
+                best_len = ex - sx;
+                best_x = sx;
+                best_y = sy;
+            }
+            next_y = std::max(next_y, ey);
+        }
+        y = next_y;
+    }
+    // Leave the tables zeroed for the next range.
+    for (long x = r.xoff; x < r.xlim; ++x)
+        m_count_a[m_a[x]] = 0;
+
+    if (best_len == 0) {
+        work.push_back({ r.xoff, r.xlim, r.yoff, r.ylim, DiffAlgorithm::MYERS });
+        return;
+    }
+    work.push_back({ best_x + best_len, r.xlim, best_y + best_len, r.ylim, DiffAlgorithm::HISTOGRAM });
+    work.push_back({ r.xoff, best_x, r.yoff, best_y, DiffAlgorithm::HISTOGRAM });
+}
+
+// @brief Collect runs of changed lines into hunks.
+std::vector<Hunk>
+collectHunks(const std::vector<char>& changed_a, const std::vector<char>& changed_b)
+{
+    std::vector<Hunk> hunks;
+    const long n = static_cast<long>(changed_a.size());
+    const long m = static_cast<long>(changed_b.size());
+    long x = 0, y = 0;
+    while (x < n || y < m) {
+        if (x < n && y < m && !changed_a[x] && !changed_b[y]) {
+            ++x;
+            ++y;
+            continue;
+        }
+        Hunk hunk;
+        hunk.a_first = x;
+        hunk.b_first = y;
+        while (x < n && changed_a[x])
+            ++x;
+        while (y < m && changed_b[y])
+            ++y;
+        hunk.a_count = x - hunk.a_first;
+        hunk.b_count = y - hunk.b_first;
+        hunks.push_back(hunk);
+    }
+    return hunks;
+}
+
+// @brief Compare line i with line i and report each run of differing lines.
+std::vector<Hunk>
+diffPositional(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b)
+{
+    std::vector<Hunk> hunks;
+    const int64_t n = static_cast<int64_t>(a.size());
+    const int64_t m = static_cast<int64_t>(b.size());
+    for (int64_t i = 0; i < std::max(n, m);) {
+        if (i < n && i < m && a[i] == b[i]) {
+            ++i;
+            continue;
+        }
+        Hunk hunk;
+        hunk.a_first = hunk.b_first = i;
+        while (i < std::max(n, m) && !(i < n && i < m && a[i] == b[i]))
+            ++i;
+        hunk.a_count = std::min(i, n) - std::min(hunk.a_first, n);
+        hunk.b_count = std::min(i, m) - std::min(hunk.b_first, m);
+        hunks.push_back(hunk);
+    }
+    return hunks;
+}
+
+// @brief Format a one based line range, like "line 5" or "lines 5-7".
+std::string
+lineRange(int64_t first, int64_t count)
+{
+    if (count == 1)
+        return "line " + std::to_string(first + 1);
+    return "lines " + std::to_string(first + 1) + "-" + std::to_string(first + count);
+}
+
+// @brief Append the "@@" line that says what a hunk does.
+void
+appendHunkTitle(std::string& out, const Hunk& hunk, int64_t number)
+{
+    out += "@@ " + std::to_string(number) + ", ";
+    if (hunk.b_count == 0)
+        out += "deleted a " + lineRange(hunk.a_first, hunk.a_count) + " after b line " + std::to_string(hunk.b_first);
+    else if (hunk.a_count == 0)
+        out += "inserted b " + lineRange(hunk.b_first, hunk.b_count) + " after a line " + std::to_string(hunk.a_first);
+    else
+        out += "changed a " + lineRange(hunk.a_first, hunk.a_count) + " to b " + lineRange(hunk.b_first, hunk.b_count);
+    out += "\n";
+}
+
+} // namespace
+
+bool
+parseDiffAlgorithm(const std::string& name, DiffAlgorithm& algorithm)
+{
+    for (const DiffAlgorithm a : { DiffAlgorithm::POSITIONAL, DiffAlgorithm::MYERS, DiffAlgorithm::PATIENCE, DiffAlgorithm::HISTOGRAM }) {
+        if (name == getDiffAlgorithmName(a)) {
+            algorithm = a;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char*
+getDiffAlgorithmName(DiffAlgorithm algorithm)
+{
+    switch (algorithm) {
+        case DiffAlgorithm::MYERS:
+            return "myers";
+        case DiffAlgorithm::PATIENCE:
+            return "patience";
+        case DiffAlgorithm::HISTOGRAM:
+            return "histogram";
+        default:
+            return "positional";
+    }
+}
+
+// @brief Format the "@@" record of a hunk as a string.
+std::string
+formatHunk(const File& file_a, const File& file_b, const Hunk& hunk, int64_t number, bool with_pretty_le)
+{
+    std::string text;
+    appendHunk(text, file_a, file_b, hunk, number, with_pretty_le);
+    return text;
+}
+
+// @brief Append the "@@" record of a hunk to out.
+//        The lines are appended straight from the files, without a copy per line.
+void
+appendHunk(std::string& out, const File& file_a, const File& file_b, const Hunk& hunk, int64_t number, bool with_pretty_le)
+{
+    appendHunkTitle(out, hunk, number);
+
+    size_t cursor = file_a.findLine(hunk.a_first);
+    for (int64_t i = 0; i < hunk.a_count; ++i) {
+        out += "File a: ";
+        const std::string_view line = file_a.getLine(cursor);
+        out += line;
+        if (with_pretty_le)
+            out += file_a.getPrettyLE(line);
+        out += "\n";
+    }
+    cursor = file_b.findLine(hunk.b_first);
+    for (int64_t i = 0; i < hunk.b_count; ++i) {
+        out += "File b: ";
+        const std::string_view line = file_b.getLine(cursor);
+        out += line;
+        if (with_pretty_le)
+            out += file_b.getPrettyLE(line);
+        out += "\n";
+    }
+    out += "\n";
+}
+
+// @brief Append the "@@" record of a hunk whose lines were read already.
+void
+appendHunk(std::string& out, const Hunk& hunk, int64_t number, const std::vector<std::string>& lines_a, const std::vector<std::string>& lines_b)
+{
+    appendHunkTitle(out, hunk, number);
+    for (const std::string& line : lines_a) {
+        out += "File a: ";
+        out += line;
+        out += "\n";
+    }
+    for (const std::string& line : lines_b) {
+        out += "File b: ";
+        out += line;
+        out += "\n";
+    }
+    out += "\n";
+}
+
+// @brief Diff two sequences of line ids.
+//        Ids are first renumbered densely. Lines with no equal line on the other
+//        side can't be part of the common subsequence, so they are marked as
+//        changed right away and left out of the search (as xdiff does). That keeps
+//        heavily different files cheap to diff.
+std::vector<Hunk>
+diffSequences(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b, DiffAlgorithm algorithm)
+{
+    if (algorithm == DiffAlgorithm::POSITIONAL)
+        return diffPositional(a, b);
+
+    std::unordered_map<uint64_t, uint32_t> dense;
+    dense.reserve(a.size());
+    std::vector<uint32_t> dense_a(a.size());
+    for (size_t x = 0; x < a.size(); ++x)
+        dense_a[x] = dense.try_emplace(a[x], static_cast<uint32_t>(dense.size())).first->second;
+    std::vector<char> in_b(dense.size(), 0);
+    // Ids only found in file b all map to a single id that matches nothing.
+    const uint32_t no_match = static_cast<uint32_t>(dense.size());
+    std::vector<uint32_t> dense_b(b.size());
+    for (size_t y = 0; y < b.size(); ++y) {
+        const auto it = dense.find(b[y]);
+        dense_b[y] = (it == dense.end()) ? no_match : it->second;
+        if (it != dense.end())
+            in_b[it->second] = 1;
+    }
+
+    // Keep only the lines that have a match on the other side.
+    std::vector<char> changed_a(a.size(), 1);
+    std::vector<char> changed_b(b.size(), 1);
+    std::vector<uint32_t> kept_a, kept_b;
+    std::vector<long> index_a, index_b;
+    for (size_t x = 0; x < a.size(); ++x) {
+        if (in_b[dense_a[x]]) {
+            kept_a.push_back(dense_a[x]);
+            index_a.push_back(static_cast<long>(x));
+        }
+    }
+    for (size_t y = 0; y < b.size(); ++y) {
+        if (dense_b[y] != no_match) {
+            kept_b.push_back(dense_b[y]);
+            index_b.push_back(static_cast<long>(y));
+        }
+    }
+
+    Differ differ(kept_a, kept_b, dense.size());
+    differ.run(algorithm);
+    for (size_t x = 0; x < kept_a.size(); ++x)
+        changed_a[index_a[x]] = differ.isChangedA(static_cast<long>(x));
+    for (size_t y = 0; y < kept_b.size(); ++y)
+        changed_b[index_b[y]] = differ.isChangedB(static_cast<long>(y));
+    return collectHunks(changed_a, changed_b);
+}
+
+// @brief Hash the lines of a file the way diffFiles() would, once for all the
+//        files it is diffed against.
+void
+hashFileLines(const File& file, const Normalization& normalization, bool le_ignore, FileLineIds& ids)
+{
+    if (!normalization.any() && !file.hasLineIndex())
+        return;
+    ScopedPhase phase(StatPhase::DIFF);
+    phase.addLines(static_cast<uint64_t>(file.getLineCount()));
+    if (normalization.any()) {
+        std::string scratch;
+        ids.normalized.reserve(static_cast<size_t>(file.getLineCount()));
+        for (const std::string_view line : lines(file))
+            ids.normalized.push_back(hashNormalized(line, normalization, scratch));
+    }
+    if (le_ignore)
+        return;
+    ids.with_le = normalization.any() ? ids.normalized : file.getLineIndex().getHashes();
+    size_t i = 0;
+    for (const std::string_view line : lines(file))
+        ids.with_le[i++] ^= file.endsInCrlf(line) ? crlf_salt : 0;
+}
+
+// @brief Turn the lines of both files into ids (equal lines get equal ids) and diff those.
+//        Under a normalization, the normalized line hashes serve as ids. Otherwise the
+//        line hashes do when both files have a line index, or else the lines are
+//        interned. When line endings count and files mix them, the ending of each
+//        line is folded into its id. The lines before start are known to be equal
+//        and are left out. The ids of file a are taken from ids_a when given.
+std::vector<Hunk>
+diffFiles(const File& file_a, const File& file_b, const MatchPoint& start, DiffAlgorithm algorithm, bool le_ignore, const Normalization& normalization,
+          const FileLineIds* ids_a)
+{
+    const int64_t lines_a = std::max<int64_t>(0, file_a.getLineCount() - start.line);
+    const int64_t lines_b = std::max<int64_t>(0, file_b.getLineCount() - start.line);
+    const bool compare_le = !le_ignore && lineEndingsDiffer(file_a, file_b);
+    if (compare_le && !file_a.hasMixedLineEndings() && !file_b.hasMixedLineEndings()) {
+        // Every line ends differently, so every remaining line differs.
+        Hunk hunk;
+        hunk.a_first = hunk.b_first = start.line;
+        hunk.a_count = lines_a;
+        hunk.b_count = lines_b;
+        return { hunk };
+    }
+
+    ScopedPhase phase(StatPhase::DIFF);
+    phase.addLines(static_cast<uint64_t>(lines_a + lines_b));
+    std::vector<uint64_t> a, b;
+    // Ids of file a hashed before come with their line endings folded in.
+    const bool known_a = ids_a != nullptr && ((normalization.any() && !ids_a->normalized.empty()) || (file_a.hasLineIndex() && file_b.hasLineIndex()));
+    if (known_a) {
+        const std::vector<uint64_t>& all_a = (compare_le && !ids_a->with_le.empty()) ? ids_a->with_le
+                                             : normalization.any()                   ? ids_a->normalized
+                                                                                     : file_a.getLineIndex().getHashes();
+        a.assign(all_a.begin() + start.line, all_a.end());
+    }
+    if (normalization.any()) {
+        std::string scratch;
+        b.reserve(static_cast<size_t>(lines_b));
+        if (!known_a) {
+            a.reserve(static_cast<size_t>(lines_a));
+            for (const std::string_view line : lines(file_a, start.offset_a))
+                a.push_back(hashNormalized(line, normalization, scratch));
+        }
+        for (const std::string_view line : lines(file_b, start.offset_b))
+            b.push_back(hashNormalized(line, normalization, scratch));
+    } else if (file_a.hasLineIndex() && file_b.hasLineIndex()) {
+        const std::vector<uint64_t>& hashes_a = file_a.getLineIndex().getHashes();
+        const std::vector<uint64_t>& hashes_b = file_b.getLineIndex().getHashes();
+        if (!known_a)
+            a.assign(hashes_a.begin() + start.line, hashes_a.end());
+        b.assign(hashes_b.begin() + start.line, hashes_b.end());
+    } else {
+        std::unordered_map<std::string_view, uint64_t> ids;
+        ids.reserve(static_cast<size_t>(lines_a));
+        auto intern = [&ids](std::string_view line) {
+            return ids.try_emplace(line, ids.size()).first->second;
+        };
+        a.reserve(static_cast<size_t>(lines_a));
+        b.reserve(static_cast<size_t>(lines_b));
+        for (const std::string_view line : lines(file_a, start.offset_a))
+            a.push_back(intern(line));
+        for (const std::string_view line : lines(file_b, start.offset_b))
+            b.push_back(intern(line));
+    }
+
+    if (compare_le) {
+        // Fold the line ending into the id, so a CRLF line never matches a LF line.
+        size_t i = 0;
+        if (!known_a) {
+            for (const std::string_view line : lines(file_a, start.offset_a))
+                a[i++] ^= file_a.endsInCrlf(line) ? crlf_salt : 0;
+        }
+        i = 0;
+        for (const std::string_view line : lines(file_b, start.offset_b))
+            b[i++] ^= file_b.endsInCrlf(line) ? crlf_salt : 0;
+    }
+
+    std::vector<Hunk> hunks = diffSequences(a, b, algorithm);
+    for (auto& hunk : hunks) {
+        hunk.a_first += start.line;
+        hunk.b_first += start.line;
+    }
+    return hunks;
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,96 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "Compare.h"
+#include "File.h"
+
+// System includes.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace AbeCmp {
+
+// The ways lines of file a can be matched up with lines of file b.
+enum class DiffAlgorithm
+{
+    // Line i of file a is compared with line i of file b.
+    POSITIONAL,
+    // Shortest edit script (Myers O(ND), linear space).
+    MYERS,
+    // Anchor on lines that are unique in both files, Myers in between.
+    PATIENCE,
+    // Anchor on the least frequent lines, Myers in between.
+    HISTOGRAM
+};
+
+// A run of lines in file a that was replaced by a run of lines in file b.
+// A count of zero on one side makes it a pure insertion or deletion.
+struct Hunk
+{
+    // Zero based first line and number of lines in each file.
+    int64_t a_first = 0;
+    int64_t a_count = 0;
+    int64_t b_first = 0;
+    int64_t b_count = 0;
+};
+
+// Look up an algorithm by its command line name. Returns false for unknown names.
+bool parseDiffAlgorithm(const std::string& name, DiffAlgorithm& algorithm);
+// The command line name of an algorithm.
+const char* getDiffAlgorithmName(DiffAlgorithm algorithm);
+
+// Format a hunk as an "@@" record followed by the lines it holds, each with its
+// own pretty line ending when with_pretty_le is set.
+std::string formatHunk(const File& file_a, const File& file_b, const Hunk& hunk, int64_t number, bool with_pretty_le);
+// Append the "@@" record of a hunk to out.
+void appendHunk(std::string& out, const File& file_a, const File& file_b, const Hunk& hunk, int64_t number, bool with_pretty_le);
+// Append the "@@" record of a hunk whose lines were read already, with their
+// pretty line endings if they are to be shown.
+void appendHunk(std::string& out, const Hunk& hunk, int64_t number, const std::vector<std::string>& lines_a, const std::vector<std::string>& lines_b);
+
+// Diff two sequences of line ids (or line hashes) and return the hunks where they differ.
+std::vector<Hunk> diffSequences(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b, DiffAlgorithm algorithm);
+// The line ids of a file hashed once, to diff the file against many others.
+struct FileLineIds
+{
+    // The normalized hash of each line, empty without a normalization (the
+    // line hashes of the line index serve then).
+    std::vector<uint64_t> normalized;
+    // The ids of the lines with their line endings folded in, for when line
+    // endings count. Empty if le_ignore was set.
+    std::vector<uint64_t> with_le;
+};
+
+// Hash the lines of a file once for diffFiles(). Without a normalization the
+// file needs a line index, or no ids are kept.
+void hashFileLines(const File& file, const Normalization& normalization, bool le_ignore, FileLineIds& ids);
+
+// Diff all lines of both files from start on.
+// When both files have a line index, the line hashes are used as ids, so lines
+// with equal 64-bit hashes are taken to be equal.
+// Unless le_ignore is set, lines only match if their line endings match too.
+// Under a normalization, lines are hashed in normalized form instead.
+// ids_a are the ids of file a from hashFileLines(), with the same normalization
+// and le_ignore, so they aren't hashed again.
+std::vector<Hunk> diffFiles(const File& file_a, const File& file_b, const MatchPoint& start, DiffAlgorithm algorithm, bool le_ignore,
+                            const Normalization& normalization = Normalization(), const FileLineIds* ids_a = nullptr);
+
+} // namespace AbeCmp
@@ -0,0 +1,466 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "DiffWriter.h"
+#include "LineIterator.h"
+#include "Stats.h"
+
+namespace AbeCmp {
+
+// Write out the buffer in blocks of about this size.
+const static size_t output_flush_size = 1 << 20;
+
+namespace {
+
+const char* const format_names[] = { "text", "unified", "json" };
+
+// Follows a unified hunk line that has no line ending, so patch keeps it so.
+const char no_newline_marker[] = "\\ No newline at end of file\n";
+
+// @brief Append s and then suffix as one quoted JSON string.
+//        Bytes above 0x7f are copied as they are, so UTF-8 text stays readable.
+void
+appendJsonString(std::string& out, std::string_view s, std::string_view suffix = {})
+{
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (const std::string_view part : { s, suffix }) {
+        for (const char c : part) {
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out += "\\u00";
+                        out += hex[(c >> 4) & 0xf];
+                        out += hex[c & 0xf];
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+    }
+    out += '"';
+}
+
+// @brief Append a one based unified diff range, like "5", "5,3" or "4,0".
+//        An empty range names the line before it, as diff does.
+void
+appendUnifiedRange(std::string& out, int64_t first, int64_t count)
+{
+    out += std::to_string(count == 0 ? first : first + 1);
+    if (count != 1) {
+        out += ',';
+        out += std::to_string(count);
+    }
+}
+
+// @brief Append the lines of a hunk from one file, as the items of a JSON
+//        array, or as prefixed unified diff lines that keep their raw line
+//        endings (a patch must match the bytes of the file).
+void
+appendHunkLines(std::string& out, const File& file, int64_t first, int64_t count, bool with_pretty_le, const char* prefix, bool json)
+{
+    // A last line without a line ending takes the line ending of the file.
+    const int64_t unterminated = file.endsInNewline() ? -1 : file.getLineCount() - 1;
+    int64_t i = 0;
+    for (auto it = linesFrom(file, first).begin(); i < count; ++it, ++i) {
+        if (json) {
+            if (i > 0)
+                out += ',';
+            appendJsonString(out, *it, with_pretty_le ? file.getPrettyLE(*it) : "");
+        } else {
+            out += prefix;
+            out += *it;
+            if (first + i != unterminated && file.endsInCrlf(*it))
+                out += '\r';
+            out += '\n';
+        }
+    }
+}
+
+// @brief True if the lines of a hunk end with the last line of the file and it
+//        has no line ending.
+bool
+endsWithoutNewline(const File& file, int64_t first, int64_t count)
+{
+    return count > 0 && first + count == file.getLineCount() && !file.endsInNewline();
+}
+
+// @brief Append a byte as up to three octal digits, right aligned in three
+//        columns like printf("%3o").
+void
+appendOctal(std::string& out, unsigned char byte)
+{
+    char digits[3] = { ' ', ' ', ' ' };
+    int i = 2;
+    do {
+        digits[i--] = static_cast<char>('0' + (byte & 7));
+        byte >>= 3;
+    } while (byte != 0);
+    out.append(digits, 3);
+}
+
+// @brief Append a one based line range like "257-512", or "-" for no lines.
+void
+appendLineRange(std::string& out, int64_t first, int64_t count)
+{
+    if (count == 0) {
+        out += '-';
+        return;
+    }
+    out += std::to_string(first + 1);
+    out += '-';
+    out += std::to_string(first + count);
+}
+
+// @brief Append lines that were read already, as prefixed text lines or as
+//        the items of a JSON array.
+void
+appendHunkLines(std::string& out, const std::vector<std::string>& lines, const char* prefix, bool json)
+{
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (json) {
+            if (i > 0)
+                out += ',';
+            appendJsonString(out, lines[i]);
+        } else {
+            out += prefix;
+            out += lines[i];
+            out += '\n';
+        }
+    }
+}
+
+} // namespace
+
+bool
+parseOutputFormat(const std::string& name, OutputFormat& format)
+{
+    for (const OutputFormat f : { OutputFormat::TEXT, OutputFormat::UNIFIED, OutputFormat::JSON }) {
+        if (name == getOutputFormatName(f)) {
+            format = f;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char*
+getOutputFormatName(OutputFormat format)
+{
+    return format_names[static_cast<int>(format)];
+}
+
+DiffWriter::DiffWriter(OutputFormat format, FILE* out)
+  : m_format(format)
+  , m_out(out)
+{
+    m_buffer.reserve(output_flush_size + output_flush_size / 2);
+}
+
+DiffWriter::~DiffWriter()
+{
+    flush();
+}
+
+void
+DiffWriter::writeHeader(const std::string& name_a, const std::string& name_b)
+{
+    if (m_format == OutputFormat::UNIFIED) {
+        m_buffer += "--- " + name_a + "\n";
+        m_buffer += "+++ " + name_b + "\n";
+    } else if (m_format == OutputFormat::JSON) {
+        m_buffer += "{\"type\":\"files\",\"a\":";
+        appendJsonString(m_buffer, name_a);
+        m_buffer += ",\"b\":";
+        appendJsonString(m_buffer, name_b);
+        m_buffer += "}\n";
+    }
+}
+
+// @brief Write a line that differs at the same position in both files.
+//        Text records follow a blank line, like the rest of the report.
+void
+DiffWriter::writeLineDiff(const LineDiff& diff, int64_t number)
+{
+    switch (m_format) {
+        case OutputFormat::TEXT:
+            if (m_records == 0)
+                m_buffer += '\n';
+            appendLineDiff(m_buffer, diff, number);
+            break;
+        case OutputFormat::UNIFIED:
+            if (m_run_count > 0 && diff.line != m_run_first + m_run_count)
+                flushRun();
+            if (m_run_count == 0)
+                m_run_first = diff.line;
+            ++m_run_count;
+            m_run_a += '-';
+            m_run_a += diff.line_a;
+            m_run_a += diff.crlf_a ? "\r\n" : "\n";
+            // The last line of a file ends its run, so the marker can follow it here.
+            if (diff.no_newline_a)
+                m_run_a += no_newline_marker;
+            m_run_b += '+';
+            m_run_b += diff.line_b;
+            m_run_b += diff.crlf_b ? "\r\n" : "\n";
+            if (diff.no_newline_b)
+                m_run_b += no_newline_marker;
+            break;
+        case OutputFormat::JSON:
+            m_buffer += "{\"type\":\"line\",\"number\":" + std::to_string(number);
+            m_buffer += ",\"line\":" + std::to_string(diff.line + 1);
+            m_buffer += ",\"a\":";
+            appendJsonString(m_buffer, diff.line_a, diff.pretty_le_a);
+            m_buffer += ",\"b\":";
+            appendJsonString(m_buffer, diff.line_b, diff.pretty_le_b);
+            m_buffer += "}\n";
+            break;
+    }
+    ++m_records;
+    flushIfFull();
+}
+
+// @brief Write a hunk found by a diff algorithm.
+void
+DiffWriter::writeHunk(const File& file_a, const File& file_b, const Hunk& hunk, int64_t number, bool with_pretty_le)
+{
+    switch (m_format) {
+        case OutputFormat::TEXT:
+            if (m_records == 0)
+                m_buffer += '\n';
+            appendHunk(m_buffer, file_a, file_b, hunk, number, with_pretty_le);
+            break;
+        case OutputFormat::UNIFIED:
+            m_buffer += "@@ -";
+            appendUnifiedRange(m_buffer, hunk.a_first, hunk.a_count);
+            m_buffer += " +";
+            appendUnifiedRange(m_buffer, hunk.b_first, hunk.b_count);
+            m_buffer += " @@\n";
+            appendHunkLines(m_buffer, file_a, hunk.a_first, hunk.a_count, false, "-", false);
+            if (endsWithoutNewline(file_a, hunk.a_first, hunk.a_count))
+                m_buffer += no_newline_marker;
+            appendHunkLines(m_buffer, file_b, hunk.b_first, hunk.b_count, false, "+", false);
+            if (endsWithoutNewline(file_b, hunk.b_first, hunk.b_count))
+                m_buffer += no_newline_marker;
+            break;
+        case OutputFormat::JSON:
+            m_buffer += "{\"type\":\"hunk\",\"number\":" + std::to_string(number);
+            m_buffer += ",\"a_first\":" + std::to_string(hunk.a_first + 1) + ",\"a_count\":" + std::to_string(hunk.a_count);
+            m_buffer += ",\"b_first\":" + std::to_string(hunk.b_first + 1) + ",\"b_count\":" + std::to_string(hunk.b_count);
+            m_buffer += ",\"a\":[";
+            appendHunkLines(m_buffer, file_a, hunk.a_first, hunk.a_count, with_pretty_le, "", true);
+            m_buffer += "],\"b\":[";
+            appendHunkLines(m_buffer, file_b, hunk.b_first, hunk.b_count, with_pretty_le, "", true);
+            m_buffer += "]}\n";
+            break;
+    }
+    ++m_records;
+    flushIfFull();
+}
+
+// @brief Write a byte that differs. Text records are the one based offset and
+//        both bytes in octal, as cmp -l prints them.
+void
+DiffWriter::writeByteDiff(const ByteDiff& diff, int64_t number)
+{
+    if (m_format == OutputFormat::JSON) {
+        m_buffer += "{\"type\":\"byte\",\"number\":" + std::to_string(number);
+        m_buffer += ",\"byte\":" + std::to_string(diff.offset + 1);
+        m_buffer += ",\"a\":" + std::to_string(diff.byte_a);
+        m_buffer += ",\"b\":" + std::to_string(diff.byte_b);
+        m_buffer += "}\n";
+    } else {
+        if (m_records == 0)
+            m_buffer += '\n';
+        m_buffer += std::to_string(diff.offset + 1);
+        m_buffer += ' ';
+        appendOctal(m_buffer, diff.byte_a);
+        m_buffer += ' ';
+        appendOctal(m_buffer, diff.byte_b);
+        m_buffer += '\n';
+    }
+    ++m_records;
+    flushIfFull();
+}
+
+// @brief Write a hunk whose lines were read already.
+void
+DiffWriter::writeHunk(const Hunk& hunk, int64_t number, const std::vector<std::string>& lines_a, const std::vector<std::string>& lines_b, bool no_newline_a,
+                      bool no_newline_b)
+{
+    switch (m_format) {
+        case OutputFormat::TEXT:
+            if (m_records == 0)
+                m_buffer += '\n';
+            appendHunk(m_buffer, hunk, number, lines_a, lines_b);
+            break;
+        case OutputFormat::UNIFIED:
+            m_buffer += "@@ -";
+            appendUnifiedRange(m_buffer, hunk.a_first, hunk.a_count);
+            m_buffer += " +";
+            appendUnifiedRange(m_buffer, hunk.b_first, hunk.b_count);
+            m_buffer += " @@\n";
+            appendHunkLines(m_buffer, lines_a, "-", false);
+            if (no_newline_a)
+                m_buffer += no_newline_marker;
+            appendHunkLines(m_buffer, lines_b, "+", false);
+            if (no_newline_b)
+                m_buffer += no_newline_marker;
+            break;
+        case OutputFormat::JSON:
+            m_buffer += "{\"type\":\"hunk\",\"number\":" + std::to_string(number);
+            m_buffer += ",\"a_first\":" + std::to_string(hunk.a_first + 1) + ",\"a_count\":" + std::to_string(hunk.a_count);
+            m_buffer += ",\"b_first\":" + std::to_string(hunk.b_first + 1) + ",\"b_count\":" + std::to_string(hunk.b_count);
+            m_buffer += ",\"a\":[";
+            appendHunkLines(m_buffer, lines_a, "", true);
+            m_buffer += "],\"b\":[";
+            appendHunkLines(m_buffer, lines_b, "", true);
+            m_buffer += "]}\n";
+            break;
+    }
+    ++m_records;
+    flushIfFull();
+}
+
+// @brief Write the similarity of each region. The text table has a row per
+//        region; JSON has a region object per region and a similarity object.
+void
+DiffWriter::writeSimilarity(const SimilarityResult& result)
+{
+    char number[32];
+    if (m_format == OutputFormat::JSON) {
+        for (size_t i = 0; i < result.regions.size(); ++i) {
+            const SimilarityRegion& region = result.regions[i];
+            snprintf(number, sizeof(number), "%.4f", region.similarity);
+            m_buffer += "{\"type\":\"region\",\"number\":" + std::to_string(i + 1);
+            m_buffer += ",\"a_first\":" + std::to_string(region.a_first + 1) + ",\"a_count\":" + std::to_string(region.a_count);
+            m_buffer += ",\"b_first\":" + std::to_string(region.b_first + 1) + ",\"b_count\":" + std::to_string(region.b_count);
+            m_buffer += ",\"similarity\":";
+            m_buffer += number;
+            m_buffer += "}\n";
+        }
+        snprintf(number, sizeof(number), "%.4f", result.similarity);
+        m_buffer += "{\"type\":\"similarity\",\"similarity\":";
+        m_buffer += number;
+        m_buffer += ",\"lines_a\":" + std::to_string(result.lines_a) + ",\"lines_b\":" + std::to_string(result.lines_b);
+        m_buffer += ",\"region_lines\":" + std::to_string(result.region_lines) + "}\n";
+    } else {
+        char row[96];
+        m_buffer += "\nRegion              Lines a              Lines b  Similarity\n";
+        for (size_t i = 0; i < result.regions.size(); ++i) {
+            const SimilarityRegion& region = result.regions[i];
+            std::string range_a, range_b;
+            appendLineRange(range_a, region.a_first, region.a_count);
+            appendLineRange(range_b, region.b_first, region.b_count);
+            snprintf(row, sizeof(row), "%6zu %20s %20s %10.1f%%\n", i + 1, range_a.c_str(), range_b.c_str(), 100.0 * region.similarity);
+            m_buffer += row;
+        }
+    }
+    m_records += static_cast<int64_t>(result.regions.size());
+    flushIfFull();
+}
+
+void
+DiffWriter::writeSummary(const OutputSummary& summary)
+{
+    if (m_format != OutputFormat::JSON)
+        return;
+    flushRun();
+    m_buffer += "{\"type\":\"summary\",\"match\":";
+    m_buffer += summary.match ? "true" : "false";
+    if (summary.line_counts_differ)
+        m_buffer += ",\"line_counts_differ\":true,\"lines_a\":" + std::to_string(summary.lines_a) + ",\"lines_b\":" + std::to_string(summary.lines_b);
+    if (summary.sizes_differ)
+        m_buffer += ",\"sizes_differ\":true,\"size_a\":" + std::to_string(summary.size_a) + ",\"size_b\":" + std::to_string(summary.size_b);
+    m_buffer += ",\"compared\":" + std::to_string(summary.compared);
+    m_buffer += ",\"differences\":" + std::to_string(summary.differences);
+    m_buffer += ",\"stopped\":";
+    m_buffer += summary.stopped ? "true" : "false";
+    m_buffer += "}\n";
+}
+
+void
+DiffWriter::writeStats()
+{
+    if (m_format == OutputFormat::JSON)
+        m_buffer += Stats::formatJson();
+}
+
+void
+DiffWriter::flush()
+{
+    flushRun();
+    writeBuffer();
+    fflush(m_out);
+}
+
+void
+DiffWriter::flushIfFull()
+{
+    if (m_buffer.size() >= output_flush_size)
+        writeBuffer();
+}
+
+// @brief Write out and empty the buffer. Its capacity is kept for the next records.
+void
+DiffWriter::writeBuffer()
+{
+    if (m_buffer.empty())
+        return;
+    ScopedPhase phase(StatPhase::WRITE);
+    phase.addBytes(m_buffer.size());
+    Stats::add(StatCounter::WRITE_CALLS);
+    Stats::add(StatCounter::WRITE_BYTES, m_buffer.size());
+    fwrite(m_buffer.data(), 1, m_buffer.size(), m_out);
+    m_buffer.clear();
+}
+
+// @brief Write the collected run of consecutive differing lines as one unified hunk.
+void
+DiffWriter::flushRun()
+{
+    if (m_run_count == 0)
+        return;
+    m_buffer += "@@ -";
+    appendUnifiedRange(m_buffer, m_run_first, m_run_count);
+    m_buffer += " +";
+    appendUnifiedRange(m_buffer, m_run_first, m_run_count);
+    m_buffer += " @@\n";
+    m_buffer += m_run_a;
+    m_buffer += m_run_b;
+    m_run_a.clear();
+    m_run_b.clear();
+    m_run_count = 0;
+    flushIfFull();
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,123 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "BinaryCompare.h"
+#include "Compare.h"
+#include "Diff.h"
+#include "File.h"
+#include "Similarity.h"
+
+// System includes.
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace AbeCmp {
+
+// How differences are written out.
+enum class OutputFormat
+{
+    // The "@@ n, line m" records with "File a:" and "File b:" lines.
+    TEXT,
+    // A unified diff without context lines, like diff -U0.
+    UNIFIED,
+    // One JSON object per line, ending with a summary object.
+    JSON
+};
+
+// Look up an output format by its command line name. Returns false for unknown names.
+bool parseOutputFormat(const std::string& name, OutputFormat& format);
+// The command line name of an output format.
+const char* getOutputFormatName(OutputFormat format);
+
+// The outcome of a comparison, for the JSON summary object.
+struct OutputSummary
+{
+    bool match = false;
+    // The line counts differ, so the lines weren't compared.
+    bool line_counts_differ = false;
+    int64_t lines_a = 0;
+    int64_t lines_b = 0;
+    // The sizes differ (binary comparisons), so only the shorter size was compared.
+    bool sizes_differ = false;
+    uint64_t size_a = 0;
+    uint64_t size_b = 0;
+    // The number of lines (or bytes) compared and differing lines (or hunks) found.
+    int64_t compared = 0;
+    int64_t differences = 0;
+    // The comparison stopped at the --max-diffs limit.
+    bool stopped = false;
+};
+
+// Formats differences into one large reusable buffer and writes it out in big
+// blocks, instead of a formatted write (and allocations) per line.
+class DiffWriter
+{
+  public:
+    explicit DiffWriter(OutputFormat format, FILE* out = stdout);
+    ~DiffWriter();
+    DiffWriter(const DiffWriter&) = delete;
+    DiffWriter& operator=(const DiffWriter&) = delete;
+
+    // Write the file names (unified and JSON only).
+    void writeHeader(const std::string& name_a, const std::string& name_b);
+    // Write a line that differs at the same position in both files.
+    void writeLineDiff(const LineDiff& diff, int64_t number);
+    // Write a hunk found by a diff algorithm.
+    void writeHunk(const File& file_a, const File& file_b, const Hunk& hunk, int64_t number, bool with_pretty_le);
+    // Write a hunk whose lines were read already (the out-of-core diff).
+    // no_newline_a/b: the hunk ends with the last line of the file, which has
+    // no line ending.
+    void writeHunk(const Hunk& hunk, int64_t number, const std::vector<std::string>& lines_a, const std::vector<std::string>& lines_b, bool no_newline_a,
+                   bool no_newline_b);
+    // Write a byte that differs, like cmp -l (unified output writes it as text).
+    void writeByteDiff(const ByteDiff& diff, int64_t number);
+    // Write the similarity of each region, as a table or as JSON objects.
+    void writeSimilarity(const SimilarityResult& result);
+    // Write the summary object (JSON only).
+    void writeSummary(const OutputSummary& summary);
+    // Write the --stats object (JSON only).
+    void writeStats();
+    // Write out everything buffered so far.
+    void flush();
+    OutputFormat getFormat() const { return m_format; }
+
+  private:
+    // Write out the buffer once it has grown past the flush size.
+    void flushIfFull();
+    void writeBuffer();
+    // Write the run of consecutive differing lines collected for a unified hunk.
+    void flushRun();
+
+  private:
+    OutputFormat m_format;
+    FILE* m_out;
+    std::string m_buffer;
+    int64_t m_records = 0;
+    // Unified output joins consecutive differing lines into one hunk.
+    int64_t m_run_first = 0;
+    int64_t m_run_count = 0;
+    std::string m_run_a;
+    std::string m_run_b;
+};
+
+} // namespace AbeCmp
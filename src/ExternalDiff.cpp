@@ -0,0 +1,629 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Project includes.
+#include "ExternalDiff.h"
+#include "Hash.h"
+#include "Stats.h"
+#include "StreamReader.h"
+
+// System includes.
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+namespace AbeCmp {
+
+namespace {
+
+const uint64_t mib = 1 << 20;
+// Kept free for the output buffer, the temp file buffers and allocator slack.
+const uint64_t reserved_memory = 8 * mib;
+// The least memory left for sorting and diffing.
+const uint64_t min_work_memory = 16 * mib;
+// Each segment being merged gets a read buffer of at least this many records.
+const size_t min_merge_records = 4096;
+// About how much memory the diff of a gap takes per line, besides the text:
+// the line hashes, the dense ids, the changed flags and the algorithm's state.
+const uint64_t refine_bytes_per_line = 192;
+// Folded into the id of a CRLF line, so it never matches a LF line (as diffFiles() does).
+const uint64_t crlf_salt = 0x9e3779b97f4a7c15ull;
+// The side of a line (file b) is kept in the top bit of its line number.
+const uint64_t side_b = 1ull << 63;
+
+// A sort record: ordered by key, ties broken by value.
+struct Record
+{
+    uint64_t key = 0;
+    uint64_t value = 0;
+
+    bool operator<(const Record& other) const { return key < other.key || (key == other.key && value < other.value); }
+    bool operator>(const Record& other) const { return other < *this; }
+};
+
+// A temporary file that is removed from the file system right away, so it goes
+// away when it is closed, or when the process ends.
+class TempFile
+{
+  public:
+    TempFile() = default;
+    ~TempFile() { close(); }
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    // @brief Create the file in the system temp directory.
+    bool open()
+    {
+#if defined(_WIN32)
+        m_file = std::tmpfile();
+#else
+        std::error_code error;
+        std::filesystem::path dir = std::filesystem::temp_directory_path(error);
+        if (error)
+            dir = "/tmp";
+        std::string path = (dir / "abecmp-XXXXXX").string();
+        const int fd = mkstemp(path.data());
+        if (fd < 0)
+            return false;
+        unlink(path.c_str());
+        m_file = fdopen(fd, "w+b");
+        if (m_file == nullptr)
+            ::close(fd);
+#endif
+        return m_file != nullptr;
+    }
+    void close()
+    {
+        if (m_file != nullptr)
+            fclose(m_file);
+        m_file = nullptr;
+        m_size = 0;
+    }
+    // @brief Append to the end of the file.
+    bool append(const void* data, size_t size)
+    {
+        if (!seek(m_size) || fwrite(data, 1, size, m_file) != size)
+            return false;
+        m_size += size;
+        return true;
+    }
+    // @brief Read size bytes at offset.
+    bool read(uint64_t offset, void* data, size_t size)
+    {
+        return seek(offset) && fread(data, 1, size, m_file) == size;
+    }
+    uint64_t size() const { return m_size; }
+
+  private:
+    bool seek(uint64_t offset)
+    {
+#if defined(_WIN32)
+        return _fseeki64(m_file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+        return fseeko(m_file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+    }
+
+  private:
+    FILE* m_file = nullptr;
+    uint64_t m_size = 0;
+};
+
+// Sorts more records than fit in memory: runs that fill the memory are sorted
+// and written to a temporary file as segments, which are then merged. Records
+// that all fit in one run never go to disk.
+class ExternalSorter
+{
+  public:
+    explicit ExternalSorter(uint64_t memory)
+      : m_capacity(std::max<size_t>(min_merge_records, static_cast<size_t>(memory / sizeof(Record))))
+    {
+    }
+
+    // @brief Add a record, writing out the run first once it is full.
+    bool add(const Record& record)
+    {
+        if (m_run.capacity() == 0)
+            m_run.reserve(m_capacity);
+        if (m_run.size() == m_capacity && !spill())
+            return false;
+        m_run.push_back(record);
+        return true;
+    }
+
+    // @brief Sort what is left. Once there are segments, the last run is
+    //        written out too and the segments are merged down until all of
+    //        them can be read at once within merge_memory.
+    bool finish(uint64_t merge_memory)
+    {
+        if (m_segments.empty()) {
+            std::sort(m_run.begin(), m_run.end());
+            m_run_pos = 0;
+            return true;
+        }
+        if (!m_run.empty() && !spill())
+            return false;
+        std::vector<Record>().swap(m_run);
+
+        const size_t fan_in = std::max<size_t>(2, static_cast<size_t>(merge_memory / (min_merge_records * sizeof(Record))));
+        while (m_segments.size() > fan_in) {
+            if (!mergeDown(fan_in))
+                return false;
+        }
+        m_buffer_records = std::max<size_t>(min_merge_records, static_cast<size_t>(merge_memory / sizeof(Record) / m_segments.size()));
+        return startMerge(*m_file, m_segments);
+    }
+
+    // @brief Get the next record in order. Returns false at the end, or on a
+    //        read error (see hasError()).
+    bool next(Record& record)
+    {
+        if (m_file == nullptr) {
+            if (m_run_pos == m_run.size())
+                return false;
+            record = m_run[m_run_pos++];
+            return true;
+        }
+        return nextMerged(record);
+    }
+
+    bool hasError() const { return m_error; }
+    long getSegments() const { return m_spilled_segments; }
+    uint64_t getSpilledBytes() const { return m_spilled_bytes; }
+
+  private:
+    struct Segment
+    {
+        uint64_t offset = 0;
+        uint64_t count = 0;
+    };
+
+    // Reads one segment through a small buffer.
+    struct Reader
+    {
+        Segment segment;
+        uint64_t read = 0;
+        std::vector<Record> buffer;
+        size_t pos = 0;
+    };
+
+    // @brief Sort the run and append it to the temp file as a segment.
+    bool spill()
+    {
+        if (m_file == nullptr) {
+            m_file = std::make_unique<TempFile>();
+            if (!m_file->open())
+                return false;
+        }
+        std::sort(m_run.begin(), m_run.end());
+        Segment segment;
+        segment.offset = m_file->size();
+        segment.count = m_run.size();
+        if (!m_file->append(m_run.data(), m_run.size() * sizeof(Record)))
+            return false;
+        m_segments.push_back(segment);
+        ++m_spilled_segments;
+        m_spilled_bytes += m_run.size() * sizeof(Record);
+        m_run.clear();
+        return true;
+    }
+
+    // @brief Merge groups of fan_in segments into longer segments in a new temp file.
+    bool mergeDown(size_t fan_in)
+    {
+        auto merged = std::make_unique<TempFile>();
+        if (!merged->open())
+            return false;
+        std::vector<Segment> segments;
+        std::vector<Record> out;
+        out.reserve(min_merge_records);
+        m_buffer_records = min_merge_records;
+        for (size_t first = 0; first < m_segments.size(); first += fan_in) {
+            const std::vector<Segment> group(m_segments.begin() + first, m_segments.begin() + std::min(first + fan_in, m_segments.size()));
+            if (!startMerge(*m_file, group))
+                return false;
+            Segment segment;
+            segment.offset = merged->size();
+            Record record;
+            while (nextMerged(record)) {
+                out.push_back(record);
+                if (out.size() == out.capacity()) {
+                    if (!merged->append(out.data(), out.size() * sizeof(Record)))
+                        return false;
+                    segment.count += out.size();
+                    out.clear();
+                }
+            }
+            if (m_error || !merged->append(out.data(), out.size() * sizeof(Record)))
+                return false;
+            segment.count += out.size();
+            out.clear();
+            segments.push_back(segment);
+            m_spilled_bytes += segment.count * sizeof(Record);
+        }
+        m_file = std::move(merged);
+        m_segments = std::move(segments);
+        return true;
+    }
+
+    // @brief Set up a merge of the segments of file.
+    bool startMerge(TempFile& file, const std::vector<Segment>& segments)
+    {
+        m_merge_file = &file;
+        m_readers.clear();
+        m_readers.resize(segments.size());
+        m_heap = decltype(m_heap)();
+        for (size_t i = 0; i < segments.size(); ++i) {
+            m_readers[i].segment = segments[i];
+            if (!refill(m_readers[i]))
+                return false;
+            if (!m_readers[i].buffer.empty())
+                m_heap.push({ m_readers[i].buffer[0], i });
+        }
+        return true;
+    }
+
+    // @brief Read the next block of a segment into its buffer.
+    bool refill(Reader& reader)
+    {
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(m_buffer_records, reader.segment.count - reader.read));
+        reader.buffer.resize(count);
+        reader.pos = 0;
+        if (count > 0 && !m_merge_file->read(reader.segment.offset + reader.read * sizeof(Record), reader.buffer.data(), count * sizeof(Record))) {
+            m_error = true;
+            return false;
+        }
+        reader.read += count;
+        return true;
+    }
+
+    // @brief Take the smallest record of the segments being merged.
+    bool nextMerged(Record& record)
+    {
+        if (m_heap.empty() || m_error)
+            return false;
+        const size_t i = m_heap.top().second;
+        m_heap.pop();
+        Reader& reader = m_readers[i];
+        record = reader.buffer[reader.pos++];
+        if (reader.pos == reader.buffer.size() && !refill(reader))
+            return false;
+        if (reader.pos < reader.buffer.size())
+            m_heap.push({ reader.buffer[reader.pos], i });
+        return true;
+    }
+
+  private:
+    size_t m_capacity;
+    std::vector<Record> m_run;
+    size_t m_run_pos = 0;
+    std::unique_ptr<TempFile> m_file;
+    std::vector<Segment> m_segments;
+    long m_spilled_segments = 0;
+    uint64_t m_spilled_bytes = 0;
+    // The merge in progress.
+    TempFile* m_merge_file = nullptr;
+    size_t m_buffer_records = min_merge_records;
+    std::vector<Reader> m_readers;
+    std::priority_queue<std::pair<Record, size_t>, std::vector<std::pair<Record, size_t>>, std::greater<>> m_heap;
+    bool m_error = false;
+};
+
+// @brief The id of the line that a stream just returned: its hash, under the
+//        normalization if there is one, with the line ending folded in unless
+//        line endings are ignored.
+uint64_t
+lineId(std::string_view line, const StreamReader& stream, const ExternalDiffOptions& options, std::string& scratch)
+{
+    uint64_t id = options.normalization.any() ? hashNormalized(line, options.normalization, scratch) : hashBytes(line.data(), line.size());
+    if (!options.le_ignore && stream.endsInCrlf())
+        id ^= crlf_salt;
+    return id;
+}
+
+// @brief Read a file and add a (line id, line) record for each of its lines.
+bool
+addLineIds(const std::string& name, uint64_t side, const ExternalDiffOptions& options, ExternalSorter& sorter, int64_t& lines, bool& unterminated)
+{
+    StreamReader stream;
+    if (!stream.open(name))
+        return false;
+    std::string scratch;
+    std::string_view line;
+    lines = 0;
+    while (stream.nextLine(line)) {
+        if (!sorter.add({ lineId(line, stream, options, scratch), static_cast<uint64_t>(lines) | side }))
+            return false;
+        ++lines;
+    }
+    unterminated = !stream.endsInNewline();
+    return !stream.hasError();
+}
+
+// Walks both files side by side, from anchor to anchor, and diffs the lines
+// in between.
+class GapDiffer
+{
+  public:
+    GapDiffer(const ExternalDiffOptions& options, const ExternalHunkHandler& handler, uint64_t memory, ExternalDiffResult& result)
+      : m_options(options)
+      , m_handler(handler)
+      , m_result(result)
+      , m_piece_lines(static_cast<int64_t>(std::max<uint64_t>(1, memory / 2 / refine_bytes_per_line)))
+      , m_piece_bytes(std::max<uint64_t>(1, memory / 4))
+    {
+    }
+
+    bool open(const std::string& name_a, const std::string& name_b) { return m_stream_a.open(name_a) && m_stream_b.open(name_b); }
+    // True if reading a file failed, or the files changed while they were diffed.
+    bool hasFailed() const { return m_failed || m_stream_a.hasError() || m_stream_b.hasError(); }
+
+    // @brief Diff the lines up to the anchor lines end_a and end_b, then step
+    //        over the anchors. Returns false once the handler stopped the diff,
+    //        or it failed (see hasFailed()).
+    bool advanceTo(int64_t end_a, int64_t end_b, bool anchor)
+    {
+        bool first_piece = true;
+        while (m_line_a < end_a || m_line_b < end_b) {
+            readPiece(m_stream_a, m_line_a, end_a, m_piece_a);
+            readPiece(m_stream_b, m_line_b, end_b, m_piece_b);
+            const int64_t count_a = static_cast<int64_t>(m_piece_a.ids.size());
+            const int64_t count_b = static_cast<int64_t>(m_piece_b.ids.size());
+            if (count_a == 0 && count_b == 0) {
+                // A file got shorter since it was first read.
+                m_failed = true;
+                return false;
+            }
+            // A gap that doesn't fit is diffed piece against piece, which is
+            // a correct but not always the shortest diff.
+            if (!first_piece || m_line_a + count_a != end_a || m_line_b + count_b != end_b)
+                m_result.approximate_lines += count_a + count_b;
+            first_piece = false;
+            if (!diffPiece())
+                return false;
+            m_line_a += count_a;
+            m_line_b += count_b;
+        }
+        if (anchor) {
+            std::string_view line;
+            m_stream_a.nextLine(line);
+            m_stream_b.nextLine(line);
+            ++m_line_a;
+            ++m_line_b;
+        }
+        return true;
+    }
+
+  private:
+    // The lines of one file read for a diff.
+    struct Piece
+    {
+        std::vector<uint64_t> ids;
+        std::vector<std::string> lines;
+    };
+
+    // @brief Read the next lines of a gap, as many as fit in the piece limits.
+    void readPiece(StreamReader& stream, int64_t line, int64_t end, Piece& piece)
+    {
+        piece.ids.clear();
+        piece.lines.clear();
+        uint64_t bytes = 0;
+        std::string_view text;
+        while (line < end && static_cast<int64_t>(piece.ids.size()) < m_piece_lines && bytes < m_piece_bytes && stream.nextLine(text)) {
+            piece.ids.push_back(lineId(text, stream, m_options, m_scratch));
+            if (m_options.keep_lines) {
+                piece.lines.emplace_back(text);
+                if (m_options.with_pretty_le)
+                    piece.lines.back() += stream.getPrettyLE();
+                else if (m_options.with_raw_crlf && stream.endsInCrlf() && stream.endsInNewline())
+                    piece.lines.back() += '\r';
+                bytes += text.size();
+            }
+            ++line;
+        }
+    }
+
+    // @brief Diff the pieces with the chosen algorithm and hand over their hunks.
+    bool diffPiece()
+    {
+        for (const Hunk& found : diffSequences(m_piece_a.ids, m_piece_b.ids, m_options.algorithm)) {
+            Hunk hunk = found;
+            hunk.a_first += m_line_a;
+            hunk.b_first += m_line_b;
+            if (!emit(hunk, found.a_first, found.b_first))
+                return false;
+        }
+        return true;
+    }
+
+    // @brief Hand a hunk to the handler with its lines, which start at
+    //        first_a and first_b in the pieces.
+    bool emit(const Hunk& hunk, int64_t first_a, int64_t first_b)
+    {
+        m_lines_a.clear();
+        m_lines_b.clear();
+        if (m_options.keep_lines) {
+            m_lines_a.assign(m_piece_a.lines.begin() + first_a, m_piece_a.lines.begin() + first_a + hunk.a_count);
+            m_lines_b.assign(m_piece_b.lines.begin() + first_b, m_piece_b.lines.begin() + first_b + hunk.b_count);
+        }
+        ++m_result.hunks;
+        if (!m_handler(hunk, m_lines_a, m_lines_b)) {
+            m_result.stopped = true;
+            return false;
+        }
+        return true;
+    }
+
+  private:
+    const ExternalDiffOptions& m_options;
+    const ExternalHunkHandler& m_handler;
+    ExternalDiffResult& m_result;
+    // The most lines of each file, and bytes of their text, diffed at once.
+    const int64_t m_piece_lines;
+    const uint64_t m_piece_bytes;
+    StreamReader m_stream_a;
+    StreamReader m_stream_b;
+    // The next line to read from each file.
+    int64_t m_line_a = 0;
+    int64_t m_line_b = 0;
+    Piece m_piece_a;
+    Piece m_piece_b;
+    std::vector<std::string> m_lines_a;
+    std::vector<std::string> m_lines_b;
+    std::string m_scratch;
+    bool m_failed = false;
+};
+
+// @brief Keep the longest chain of anchors in a window (sorted by line in file
+//        a) whose lines in file b go up too, and start after last_b. The chain
+//        replaces the window.
+void
+chainAnchors(std::vector<Record>& window, uint64_t last_b, bool started)
+{
+    // Anchors at or before the end of the chain so far can't extend it.
+    window.erase(std::remove_if(window.begin(), window.end(), [&](const Record& anchor) { return started && anchor.value <= last_b; }),
+                 window.end());
+
+    // Patience sorting: tails[k] is the anchor that ends the best chain of k + 1.
+    std::vector<uint32_t> tails;
+    std::vector<uint32_t> previous(window.size());
+    for (uint32_t i = 0; i < window.size(); ++i) {
+        const auto pos = std::lower_bound(tails.begin(), tails.end(), window[i].value,
+                                          [&](uint32_t tail, uint64_t value) { return window[tail].value < value; });
+        previous[i] = (pos == tails.begin()) ? i : *(pos - 1);
+        if (pos == tails.end())
+            tails.push_back(i);
+        else
+            *pos = i;
+    }
+
+    std::vector<Record> chain(tails.size());
+    if (!tails.empty()) {
+        uint32_t i = tails.back();
+        for (size_t k = chain.size(); k-- > 0; i = previous[i])
+            chain[k] = window[i];
+    }
+    window = std::move(chain);
+}
+
+} // namespace
+
+uint64_t
+getMinimumMemoryLimit()
+{
+    return 2 * StreamReader::getBufferMemory() + reserved_memory + min_work_memory;
+}
+
+// @brief Diff two files within a memory limit, through sorted segments on disk.
+bool
+diffExternal(const std::string& name_a, const std::string& name_b, const ExternalDiffOptions& options, const ExternalHunkHandler& handler,
+             ExternalDiffResult& result)
+{
+    // Only one file is read at a time until the last pass, which reads both.
+    const uint64_t work = std::max(options.memory_limit, getMinimumMemoryLimit()) - 2 * StreamReader::getBufferMemory() - reserved_memory;
+
+    // 1. Sort the line ids of both files.
+    ExternalSorter ids(work);
+    {
+        ScopedPhase phase(StatPhase::SCAN);
+        if (!addLineIds(name_a, 0, options, ids, result.lines_a, result.unterminated_a) ||
+            !addLineIds(name_b, side_b, options, ids, result.lines_b, result.unterminated_b))
+            return false;
+        phase.addLines(static_cast<uint64_t>(result.lines_a + result.lines_b));
+    }
+
+    // 2. Lines whose id is found once in each file anchor the diff.
+    ScopedPhase phase(StatPhase::DIFF);
+    ExternalSorter anchors(work / 2);
+    {
+        if (!ids.finish(work / 2))
+            return false;
+        Record record;
+        bool have = ids.next(record);
+        while (have) {
+            const uint64_t key = record.key;
+            long count_a = 0;
+            long count_b = 0;
+            uint64_t line_a = 0;
+            uint64_t line_b = 0;
+            for (; have && record.key == key; have = ids.next(record)) {
+                if (record.value & side_b) {
+                    ++count_b;
+                    line_b = record.value & ~side_b;
+                } else {
+                    ++count_a;
+                    line_a = record.value;
+                }
+            }
+            if (count_a == 1 && count_b == 1) {
+                if (!anchors.add({ line_a, line_b }))
+                    return false;
+                ++result.anchors;
+            }
+        }
+        if (ids.hasError())
+            return false;
+        result.segments = ids.getSegments();
+        result.spilled_bytes = ids.getSpilledBytes();
+    }
+    if (!anchors.finish(work / 4))
+        return false;
+    result.segments += anchors.getSegments();
+    result.spilled_bytes += anchors.getSpilledBytes();
+
+    // 3. Chain the anchors window by window and diff the lines between them.
+    GapDiffer differ(options, handler, work / 2, result);
+    if (!differ.open(name_a, name_b))
+        return false;
+    // An anchor in a window takes the record and about three indexes.
+    const size_t window_size = std::max<size_t>(1, static_cast<size_t>(work / 4 / (sizeof(Record) * 2 + 2 * sizeof(uint32_t))));
+    std::vector<Record> window;
+    window.reserve(window_size);
+    uint64_t last_b = 0;
+    bool started = false;
+    Record anchor;
+    bool have = anchors.next(anchor);
+    while (have) {
+        window.clear();
+        for (; have && window.size() < window_size; have = anchors.next(anchor))
+            window.push_back(anchor);
+        chainAnchors(window, last_b, started);
+        for (const Record& link : window) {
+            if (!differ.advanceTo(static_cast<int64_t>(link.key), static_cast<int64_t>(link.value), true))
+                return !differ.hasFailed();
+        }
+        if (!window.empty()) {
+            last_b = window.back().value;
+            started = true;
+        }
+    }
+    if (anchors.hasError())
+        return false;
+    differ.advanceTo(result.lines_a, result.lines_b, false);
+    return !differ.hasFailed();
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,96 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "Diff.h"
+#include "Normalize.h"
+
+// System includes.
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace AbeCmp {
+
+struct ExternalDiffOptions
+{
+    // The most memory the diff may use, in bytes, including the read-ahead
+    // buffers of both inputs. See getMinimumMemoryLimit().
+    uint64_t memory_limit = 0;
+    // The algorithm that matches up the lines between two anchors.
+    DiffAlgorithm algorithm = DiffAlgorithm::HISTOGRAM;
+    // Lines that only differ in their line endings (LF vs CRLF) match.
+    bool le_ignore = false;
+    // Show each line with its pretty line ending.
+    bool with_pretty_le = false;
+    // Keep the CR of each CRLF line in its text, for unified output that
+    // carries the raw line endings.
+    bool with_raw_crlf = false;
+    // Keep the text of the lines of each hunk (not needed for quiet output).
+    bool keep_lines = true;
+    Normalization normalization;
+};
+
+// What the out-of-core diff did.
+struct ExternalDiffResult
+{
+    int64_t lines_a = 0;
+    int64_t lines_b = 0;
+    // True if the last line of a file has no line ending.
+    bool unterminated_a = false;
+    bool unterminated_b = false;
+    // The number of hunks handed to the handler.
+    int64_t hunks = 0;
+    // True if the handler stopped the diff.
+    bool stopped = false;
+    // The sorted runs of line hashes written to disk, and their size.
+    long segments = 0;
+    uint64_t spilled_bytes = 0;
+    // The lines that are unique in both files and anchor the diff.
+    int64_t anchors = 0;
+    // Lines between two anchors that were too many to diff at once within the
+    // limit. They were diffed piece by piece, so their hunks may be longer than
+    // needed, and are split where the pieces meet.
+    int64_t approximate_lines = 0;
+};
+
+// Receives each hunk, in file order, with the lines it holds (empty unless
+// the lines are kept). Returns false to stop the diff.
+using ExternalHunkHandler = std::function<bool(const Hunk& hunk, const std::vector<std::string>& lines_a, const std::vector<std::string>& lines_b)>;
+
+// The smallest memory limit the out-of-core diff works with.
+uint64_t getMinimumMemoryLimit();
+
+// Diff two files that may be far larger than memory, within a memory limit.
+// 1. Each file is read once and its line hashes are sorted in runs that fit in
+//    memory and written to temporary segments on disk.
+// 2. A merge of the segments finds the lines that are unique in both files;
+//    those anchors are sorted by line the same way.
+// 3. The longest chain of anchors in the same order in both files is taken,
+//    window by window, and both files are read again side by side. The lines
+//    between two anchors are diffed in memory with the chosen algorithm.
+// Both files are read with StreamReader, so they must be files that can be
+// read twice (not stdin or pipes). Temporary segments go to the system temp
+// directory (TMPDIR) and are removed as soon as they are closed. Returns false
+// if reading a file or a segment failed.
+bool diffExternal(const std::string& name_a, const std::string& name_b, const ExternalDiffOptions& options, const ExternalHunkHandler& handler,
+                  ExternalDiffResult& result);
+
+} // namespace AbeCmp
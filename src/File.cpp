@@ -16,6 +16,23 @@
  */
 
 #include "File.h"
+#include "Hash.h"
+#include "Scanner.h"
+#include "Stats.h"
+
+// System includes.
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace AbeCmp {
 
@@ -27,6 +44,11 @@ const static char* pretty_lf = "\\n";
 const static char* pretty_crlf = "\\r\\n";
 const static char* pretty_unknown = "\\0";
 
+// Read pipes and other unmappable inputs in chunks of this size.
+const static size_t read_chunk_size = 1 << 20;
+// Scan the file in blocks of this size and remember the line count at each block.
+const static size_t scan_block_size = 1 << 20;
+
 File::~File()
 {
     close();
@@ -35,9 +57,41 @@ File::~File()
 bool
 File::close()
 {
-    if (m_file.is_open())
-        m_file.close();
-    return !m_file.is_open();
+#if !defined(_WIN32)
+    if (m_mapped)
+        munmap(const_cast<char*>(m_data - m_map_offset), m_size + m_map_offset);
+#endif
+    m_mapped = false;
+    m_map_offset = 0;
+    m_data = nullptr;
+    m_size = 0;
+    m_cursor = 0;
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_compression = Compression::NONE;
+    m_checkpoints.clear();
+    m_line_index.clear();
+    m_lf_lines = 0;
+    m_crlf_lines = 0;
+    m_has_stamp = false;
+    m_has_digest = false;
+    return true;
+}
+
+// @brief Check the byte after a line view for the CR of a CRLF.
+bool
+File::endsInCrlf(std::string_view line) const
+{
+    const char* end = line.data() + line.size();
+    if (line.data() != nullptr && end < m_data + m_size)
+        return *end == crlf_le[0];
+    return m_line_ending.second == crlf_le;
+}
+
+const char*
+File::getPrettyLE(std::string_view line) const
+{
+    return endsInCrlf(line) ? pretty_crlf : pretty_lf;
 }
 
 const char*
@@ -51,114 +105,434 @@ File::getPrettyLE() const
         return pretty_unknown;
 }
 
-// @brief Initialize the line ending member by reading the file char by char.
-//        If a line ending is found, reset the cursor and return true.
+// @brief Initialize the line ending and line count members with one sweep of the
+//        vectorized scanner. The ending of every line is classified in the same
+//        pass: the scanner counts the LFs that follow a CR. The file's line ending
+//        is taken from the first LF found, or is mixed when both kinds occur.
+//        The scanner also records the offset of every checkpoint line for findLine().
+//        With with_line_index, each line of the block is hashed into the line
+//        index while the block is still in cache. With with_digest, the blocks
+//        are chained into a 128-bit digest of the whole file.
 //        If no line ending is found, set the line ending to unknown and return false.
-//        This is used to determine the line ending type of the file.
 bool
-File::initLE()
-{
-    char le_buf[3] = { '\0', '\0', '\0' };
-    char c = '\0';
-    while (!m_file.eof()) {
-        // Read the file char by char.
-        m_file.get(c);
-        // Fill up the line ending buffer...
-        le_buf[0] = le_buf[1];
-        // left shifting the buffer contents with each read...
-        le_buf[1] = c;
-        // until the buffer is holding a line ending.
-        if (le_buf[0] == crlf_le[0] && le_buf[1] == crlf_le[1]) {
-            // Matches crlf.
-            resetCursor();
-            m_line_ending = { "dos |crlf", crlf_le };
-            return true;
+File::initScan(bool with_line_index, bool with_digest)
+{
+    ScopedPhase phase(StatPhase::SCAN);
+    phase.addBytes(m_size);
+    int64_t lf_count = 0;
+    int64_t crlf_count = 0;
+    bool first_is_crlf = false;
+    m_digest[0] = m_digest[1] = 0;
+    m_has_digest = with_digest;
+    m_checkpoints.clear();
+    m_line_index.clear();
+    // The start of the line that is being indexed.
+    size_t line_start = 0;
+    auto indexLine = [&](size_t line_end, size_t next) {
+        // Leave the CR of a CRLF ending out, like getLine() does.
+        if (next > line_end && line_end > line_start && m_data[line_end - 1] == crlf_le[0])
+            --line_end;
+        m_line_index.add(hashBytes(m_data + line_start, line_end - line_start), line_start, static_cast<uint32_t>(line_end - line_start));
+        line_start = next;
+    };
+
+    for (size_t block = 0; block < m_size; block += scan_block_size) {
+        const size_t n = std::min(scan_block_size, m_size - block);
+        const ScanResult scan = scanLines(m_data + block, n, &m_checkpoints, block, lf_count);
+        if (lf_count == 0 && scan.lf_count > 0)
+            // A CRLF may be split across two blocks.
+            first_is_crlf = scan.first_is_crlf || (scan.first_lf == 0 && block > 0 && m_data[block - 1] == crlf_le[0]);
+        lf_count += scan.lf_count;
+        crlf_count += scan.crlf_count;
+        if (scan.first_lf == 0 && block > 0 && m_data[block - 1] == crlf_le[0])
+            ++crlf_count;
+
+        if (with_digest) {
+            m_digest[0] = hashBytes(m_data + block, n, m_digest[0]);
+            m_digest[1] = hashBytes(m_data + block, n, ~m_digest[1]);
         }
-        if (le_buf[1] == lf_le[0]) {
-            // Matches lf.
-            resetCursor();
-            m_line_ending = { "unix|  lf", lf_le };
-            return true;
+        if (with_line_index) {
+            if (m_line_index.empty())
+                m_line_index.reserve(static_cast<size_t>(scan.lf_count) * (m_size / n));
+            const char* end = m_data + block + n;
+            const char* p = m_data + std::max(block, line_start);
+            while (const char* lf = static_cast<const char*>(memchr(p, lf_le[0], end - p))) {
+                indexLine(static_cast<size_t>(lf - m_data), static_cast<size_t>(lf - m_data) + 1);
+                p = lf + 1;
+            }
         }
     }
-    // There was no match to a known line ending.
-    m_line_ending = { "unknown", unknown_le };
-    return false;
+    // A last line without a line ending still counts as a line.
+    m_line_count = lf_count + ((m_size > 0 && m_data[m_size - 1] != lf_le[0]) ? 1 : 0);
+    m_lf_lines = lf_count - crlf_count;
+    m_crlf_lines = crlf_count;
+    phase.addLines(static_cast<uint64_t>(m_line_count));
+    if (with_line_index && line_start < m_size)
+        indexLine(m_size, m_size);
+
+    if (lf_count == 0) {
+        // There was no match to a known line ending.
+        m_line_ending = { "unknown", unknown_le };
+        return false;
+    }
+
+    setLineEnding(first_is_crlf);
+    return true;
 }
 
-// @brief Initialize the line_count member by reading the file line by line.
-//        This is used to count the lines in the file.
-//        It also resets the cursor to the beginning of the file.
-//        This is called after the line ending is determined.
+// @brief Take the line ending, line counts, checkpoints, digest and line index
+//        from a scan cache entry instead of scanning the file.
+//        Checkpoints that were stored with another interval are used as they are.
 void
-File::initLineCount()
+File::applyScan(const ScanEntry& entry)
 {
-    m_line_count = 0;
-    std::string line_buf = {};
-    // Read each line into the temp line_buf, based on the the line ending that was found.
-    while (getline(m_file, line_buf, *m_line_ending.second)) {
-        // Count the lines with each line read.
-        ++m_line_count;
-        // Don't double count lines.
-        skipCRLF();
+    m_line_count = entry.line_count;
+    m_lf_lines = entry.lf_lines;
+    m_crlf_lines = entry.crlf_lines;
+    setLineEnding(entry.crlf);
+    m_checkpoints.assign(entry.checkpoint_interval, entry.checkpoints);
+    m_digest[0] = entry.digest[0];
+    m_digest[1] = entry.digest[1];
+    m_has_digest = true;
+    m_line_index = entry.line_index;
+}
+
+// @brief Check that the offsets of an applied cache entry stay inside the
+//        contents. Only the stored numbers are looked at, so a hit still reads
+//        nothing of the file.
+bool
+File::checkScan() const
+{
+    const std::vector<uint64_t>& checkpoints = m_checkpoints.getOffsets();
+    if (checkpoints.empty() || checkpoints.back() > m_size)
+        return false;
+    for (int64_t line = 0; line < m_line_index.size(); ++line)
+        if (m_line_index.getOffset(line) > m_size || m_line_index.getLength(line) > m_size - m_line_index.getOffset(line))
+            return false;
+    return true;
+}
+
+ScanEntry
+File::makeScanEntry() const
+{
+    ScanEntry entry;
+    entry.stamp = m_stamp;
+    entry.crlf = (m_line_ending.second == crlf_le);
+    entry.line_count = m_line_count;
+    entry.lf_lines = m_lf_lines;
+    entry.crlf_lines = m_crlf_lines;
+    entry.checkpoint_interval = m_checkpoints.getInterval();
+    entry.checkpoints = m_checkpoints.getOffsets();
+    entry.digest[0] = m_digest[0];
+    entry.digest[1] = m_digest[1];
+    entry.line_index = m_line_index;
+    return entry;
+}
+
+bool
+File::sameDigest(const File& other) const
+{
+    return m_has_digest && other.m_has_digest && m_size == other.m_size &&
+           m_digest[0] == other.m_digest[0] && m_digest[1] == other.m_digest[1];
+}
+
+// @brief Set the line ending member. A file with both kinds of line endings is
+//        labeled mixed but keeps the ending of its first line, which the last line
+//        takes when it has no line ending of its own.
+void
+File::setLineEnding(bool crlf)
+{
+    if (hasMixedLineEndings())
+        m_line_ending = { "mix |both", crlf ? crlf_le : lf_le };
+    else if (crlf)
+        // Matches crlf.
+        m_line_ending = { "dos |crlf", crlf_le };
+    else
+        // Matches lf.
+        m_line_ending = { "unix|  lf", lf_le };
+}
+
+// @brief Find the byte offset of the start of a zero based line.
+//        The checkpoint before the line is looked up directly, so at most one
+//        checkpoint interval of lines is stepped over with memchr().
+//        Returns the file size for lines past the end, also when the line count
+//        came from a cache entry that claims more lines than there are.
+size_t
+File::findLine(int64_t line) const
+{
+    if (line <= 0)
+        return 0;
+    if (line >= m_line_count)
+        return m_size;
+
+    size_t offset = static_cast<size_t>(m_checkpoints.getCheckpointOffset(line));
+    int64_t lf_count = m_checkpoints.getCheckpointLine(line);
+    while (lf_count < line) {
+        const char* lf = static_cast<const char*>(memchr(m_data + offset, lf_le[0], m_size - offset));
+        if (lf == nullptr)
+            return m_size;
+        offset = static_cast<size_t>(lf - m_data) + 1;
+        ++lf_count;
+    }
+    return offset;
+}
+
+// @brief Load the file contents.
+//        Regular files are memory mapped, anything else (pipes, devices) is read
+//        into m_buffer, so that all later passes work on the same bytes. gzip
+//        and zstd files are decompressed into m_buffer. A tail (offset > 0) of
+//        a regular file is loaded as it is.
+bool
+File::load(uint64_t offset)
+{
+    ScopedPhase phase(StatPhase::LOAD);
+#if defined(_WIN32)
+    std::ifstream file(m_name, std::ios::in | std::ios::binary);
+    if (!file.is_open() || !file.seekg(static_cast<std::streamoff>(offset)))
+        return false;
+    char chunk[4096];
+    while (file.read(chunk, sizeof(chunk)) || file.gcount() > 0)
+        m_buffer.insert(m_buffer.end(), chunk, chunk + file.gcount());
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    return offset > 0 || decompressData();
+#else
+    int fd = ::open(m_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st = {};
+    bool ok = false;
+    if (fstat(fd, &st) == 0) {
+        if (S_ISREG(st.st_mode)) {
+            m_stamp.size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+            m_stamp.mtime_ns = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+            m_stamp.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+            m_stamp.inode = static_cast<uint64_t>(st.st_ino);
+            m_stamp.device = static_cast<uint64_t>(st.st_dev);
+            m_has_stamp = true;
+        }
+        if (offset > 0) {
+            // Only regular files have a tail to pick up.
+            const uint64_t size = static_cast<uint64_t>(st.st_size);
+            if (S_ISREG(st.st_mode) && size <= offset)
+                ok = true;
+            else if (S_ISREG(st.st_mode))
+                ok = mapFile(fd, static_cast<size_t>(size), offset) || (lseek(fd, static_cast<off_t>(offset), SEEK_SET) >= 0 && readFile(fd));
+        } else if (S_ISREG(st.st_mode) && st.st_size > 0) {
+            ok = mapFile(fd, static_cast<size_t>(st.st_size)) || readFile(fd);
+        } else {
+            ok = readFile(fd);
+        }
+    }
+    ::close(fd);
+    phase.addBytes(m_size);
+    return ok && (offset > 0 || decompressData());
+#endif
+}
+
+// @brief Memory map a regular file for reading.
+//        Returns false if the mapping failed, so the caller can fall back to read().
+bool
+File::mapFile(int fd, size_t size, uint64_t offset)
+{
+#if defined(_WIN32)
+    (void)fd;
+    (void)size;
+    (void)offset;
+    return false;
+#else
+    // A mapping starts at a page boundary.
+    const uint64_t start = offset - offset % static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const size_t length = size - static_cast<size_t>(start);
+    void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(start));
+    if (addr == MAP_FAILED)
+        return false;
+    // The file is scanned and compared front to back.
+    madvise(addr, length, MADV_SEQUENTIAL);
+    Stats::add(StatCounter::MAP_CALLS);
+    Stats::add(StatCounter::MAP_BYTES, length);
+    m_map_offset = static_cast<size_t>(offset - start);
+    m_data = static_cast<const char*>(addr) + m_map_offset;
+    m_size = size - static_cast<size_t>(offset);
+    m_mapped = true;
+    return true;
+#endif
+}
+
+// @brief Read the whole file into m_buffer with plain read() calls.
+//        This is the fallback for inputs that can't be memory mapped.
+bool
+File::readFile(int fd)
+{
+#if defined(_WIN32)
+    (void)fd;
+    return false;
+#else
+    m_buffer.clear();
+    size_t used = 0;
+    for (;;) {
+        if (m_buffer.size() - used < read_chunk_size)
+            m_buffer.resize(used + read_chunk_size);
+        ssize_t n = ::read(fd, m_buffer.data() + used, m_buffer.size() - used);
+        Stats::add(StatCounter::READ_CALLS);
+        if (n < 0)
+            return false;
+        if (n == 0)
+            break;
+        used += static_cast<size_t>(n);
+    }
+    Stats::add(StatCounter::READ_BYTES, used);
+    m_buffer.resize(used);
+    m_data = m_buffer.data();
+    m_size = used;
+    return true;
+#endif
+}
+
+// @brief Replace gzip or zstd contents with the decompressed contents.
+//        The whole file is held in memory; StreamReader reads compressed files
+//        in bounded memory for the comparisons that go front to back.
+bool
+File::decompressData()
+{
+    const Compression compression = detectCompression(m_data, m_size);
+    if (compression == Compression::NONE)
+        return true;
+    std::vector<char> contents;
+    if (!decompressAll(compression, m_data, m_size, contents))
+        return false;
+#if !defined(_WIN32)
+    if (m_mapped)
+        munmap(const_cast<char*>(m_data), m_size);
+#endif
+    m_mapped = false;
+    m_buffer.swap(contents);
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+    m_compression = compression;
+    return true;
+}
+
+// @brief Open and scan the file.
+//        Regular files are mapped but not read when a cache entry still matches
+//        the file, so an unchanged file costs no I/O until its lines are compared.
+//        An entry with offsets past the contents is scanned over like a miss.
+bool
+File::open(const std::string& name, bool with_line_index, const ScanCache* cache)
+{
+    close();
+    m_name = name;
+    if (!load())
+        return false;
+
+    const bool cached = cache != nullptr && m_has_stamp;
+    ScanEntry entry;
+    if (cached && cache->lookup(m_name, m_stamp, with_line_index, entry)) {
+        applyScan(entry);
+        if (checkScan()) {
+            Stats::add(StatCounter::CACHE_HITS);
+            resetCursor();
+            return true;
+        }
+    }
+
+    if (cached)
+        Stats::add(StatCounter::CACHE_MISSES);
+    if (!initScan(with_line_index, cached)) {
+        close();
+        return false;
     }
+    if (cached)
+        cache->store(m_name, makeScanEntry());
     resetCursor();
+    return true;
 }
 
+// @brief Open the file for a byte comparison. There is no line ending or line
+//        count, and the line functions must not be used.
 bool
-File::open(const std::string& name)
+File::openBytes(const std::string& name)
 {
+    close();
     m_name = name;
-    m_file.open(name, std::ios::in);
-    if (m_file.is_open())
-        if (initLE())
-            initLineCount();
-        else
-            return close();
+    m_line_count = 0;
+    m_line_ending = { "binary", unknown_le };
+    return load();
+}
 
-    return m_file.is_open();
+// @brief Open and scan the tail of the file from offset on. Unlike open(), a
+//        tail without any line ending is not an error: the line that is being
+//        written just hasn't ended yet.
+bool
+File::openTail(const std::string& name, uint64_t offset)
+{
+    close();
+    m_name = name;
+    if (!load(offset))
+        return false;
+    initScan(false, false);
+    resetCursor();
+    return true;
 }
 
 void
 File::resetCursor()
 {
-    if (!m_file.is_open())
-        return;
-
-    m_file.clear();
-    m_file.seekg(0, std::ios::beg);
+    m_cursor = 0;
 }
 
-// @brief Skip a whole CRLF ending to avoid double counting the LF in CRLF.
-//        This is only needed for CRLF line endings.
-//        If the line ending is LF, this does nothing.
 void
-File::skipCRLF()
-{
-    if (m_line_ending.second == crlf_le) {
-        // Peek for a LF after a CR.
-        char p = m_file.peek();
-        if (p == *lf_le) {
-            // Found it, throw it away.
-            m_file.get(p);
-        }
-    }
+File::seek(size_t offset)
+{
+    m_cursor = std::min(offset, m_size);
 }
 
 // @brief Read a line and return it as a string.
 std::string
 File::readLine(bool with_pretty_le)
 {
-    // Read until the known line ending, filling the line buffer.
-    // If with_pretty_le is true, append the pretty line ending to the line buffer.
-    std::string line_buf = {};
-    getline(m_file, line_buf, *m_line_ending.second);
-    // Don't double count lines.
-    skipCRLF();
-    if (with_pretty_le)
-        return line_buf + getPrettyLE();
-    else
-        return line_buf;
+    return readLine(m_cursor, with_pretty_le);
+}
+
+// @brief Get the line that starts at cursor, without copying it.
+//        The view points into the file contents and drops the CR of a CRLF ending,
+//        line by line, so files that mix line endings keep no stray CRs.
+//        The cursor is moved to the start of the next line.
+std::string_view
+File::getLine(size_t& cursor) const
+{
+    if (cursor >= m_size)
+        return {};
+
+    const char* begin = m_data + cursor;
+    const char* end = m_data + m_size;
+    // Read until the next LF.
+    const char* lf = static_cast<const char*>(memchr(begin, lf_le[0], end - begin));
+    const char* line_end = (lf == nullptr) ? end : lf;
+    cursor = (lf == nullptr) ? m_size : static_cast<size_t>(lf - m_data) + 1;
+    if (lf != nullptr && line_end > begin && *(line_end - 1) == crlf_le[0])
+        --line_end;
+    return std::string_view(begin, line_end - begin);
+}
+
+// @brief Read the line that starts at cursor and return it as a string.
+//        The cursor is moved to the start of the next line. The string is sized
+//        once for the line and its pretty line ending; use getLine() or lines()
+//        to look at lines without copying them.
+std::string
+File::readLine(size_t& cursor, bool with_pretty_le) const
+{
+    const std::string_view line = getLine(cursor);
+    const char* pretty_le = with_pretty_le ? getPrettyLE() : "";
+    std::string line_buf;
+    line_buf.reserve(line.size() + strlen(pretty_le));
+    line_buf += line;
+    line_buf += pretty_le;
+    return line_buf;
 }
 
 } // namespace AbeCmp
@@ -17,10 +17,18 @@
 
 #pragma once
 
+// Project includes.
+#include "Decompressor.h"
+#include "LineCheckpoints.h"
+#include "LineIndex.h"
+#include "ScanCache.h"
+
 // System includes.
-// TODO: Why won't this compile?: #include <iosfwd>
-#include <fstream>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace AbeCmp {
 
@@ -29,33 +37,116 @@ class File
   public:
     File() = default;
     ~File();
+    // The file may own a memory mapping, so it is not copyable.
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
 
     // Close the file.
     bool close();
-    long getLineCount() const { return m_line_count; }
+    // The file contents and their size in bytes.
+    const char* getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+    int64_t getLineCount() const { return m_line_count; }
+    // False if the last line of the file has no line ending.
+    bool endsInNewline() const { return m_size == 0 || m_data[m_size - 1] == '\n'; }
+    // The number of lines that end in a plain LF and in a CRLF.
+    int64_t getLfLineCount() const { return m_lf_lines; }
+    int64_t getCrlfLineCount() const { return m_crlf_lines; }
+    // True if some lines end in a LF and others in a CRLF.
+    bool hasMixedLineEndings() const { return m_lf_lines > 0 && m_crlf_lines > 0; }
     std::string getLineEnding() const { return m_line_ending.first; }
     std::string getName() const { return m_name; }
+    // The compression of the file on disk. The contents are decompressed.
+    Compression getCompression() const { return m_compression; }
+    // The per line hash index, empty unless it was asked for when opening.
+    const LineIndex& getLineIndex() const { return m_line_index; }
+    bool hasLineIndex() const { return !m_line_index.empty(); }
     const char* getPrettyLE() const;
-    // Open the file (sets the path/name).
-    bool open(const std::string& name);
-    // Read a line and store it in current_line.
+    // True if a line viewed with getLine() ends in a CRLF. A last line without
+    // a line ending takes the line ending of the file.
+    bool endsInCrlf(std::string_view line) const;
+    // The pretty line ending of a line viewed with getLine().
+    const char* getPrettyLE(std::string_view line) const;
+    // The 128-bit digest of the whole file, only computed when a scan cache is used.
+    bool hasDigest() const { return m_has_digest; }
+    bool sameDigest(const File& other) const;
+    // Get the line at cursor without its line ending (LF or CRLF, whichever the
+    // line has) and advance cursor past it.
+    std::string_view getLine(size_t& cursor) const;
+    // Find the byte offset of the start of a zero based line, starting from the
+    // nearest checkpoint before it.
+    size_t findLine(int64_t line) const;
+    // The sparse line offset index that findLine() uses.
+    const LineCheckpoints& getCheckpoints() const { return m_checkpoints; }
+    // Open the file (sets the path/name), optionally building the per line hash index.
+    // With a scan cache, an unchanged file takes its scan results from the cache.
+    bool open(const std::string& name, bool with_line_index = false, const ScanCache* cache = nullptr);
+    // Open the file for a byte comparison: map (or read) it without looking for
+    // lines, so files without a line ending can be opened too.
+    bool openBytes(const std::string& name);
+    // Open the part of the file from offset to its current end as if it were
+    // the whole file, for following a file that grows. Offset must be the start
+    // of a line. A tail without a line ending opens too; its last line may still
+    // be being written, which the caller can tell from the last byte.
+    bool openTail(const std::string& name, uint64_t offset);
+    // Read the line at the cursor as a copy. See lines() in LineIterator.h for views.
     std::string readLine(bool with_pretty_le = true);
+    // Read the line at cursor as a copy and advance cursor past it. Safe to call from several threads.
+    std::string readLine(size_t& cursor, bool with_pretty_le) const;
+    // Move the cursor to a byte offset at the start of a line.
+    void seek(size_t offset);
 
   private:
-    // Init the line_ending member.
-    bool initLE();
-    // Init the line_count member.
-    void initLineCount();
+    // Take the scan results from a cache entry.
+    void applyScan(const ScanEntry& entry);
+    // Check that the offsets taken from a cache entry are inside the contents.
+    bool checkScan() const;
+    // Init the line_ending and line_count members in one sweep over the data.
+    bool initScan(bool with_line_index, bool with_digest);
+    // Collect the scan results for a cache entry.
+    ScanEntry makeScanEntry() const;
+    // Load the file contents from offset on, either memory mapped or read into m_buffer.
+    bool load(uint64_t offset = 0);
+    // Memory map a regular file of the given size, from offset on.
+    bool mapFile(int fd, size_t size, uint64_t offset = 0);
+    // Read the whole file into m_buffer (pipes, character devices, etc.).
+    bool readFile(int fd);
+    // Replace gzip or zstd contents with the decompressed contents.
+    bool decompressData();
     // Reset the cursor and go back to the file beginnings.
     void resetCursor();
-    // Skip a whole CRLF ending to avoid double counting the LF in CRLF.
-    void skipCRLF();
+    // Set the line ending member from the ending of the first line and the line ending counts.
+    void setLineEnding(bool crlf);
 
   private:
-    // Object to open and read lines in the file.
-    std::ifstream m_file;
+    // The file contents, pointing into the mapping or into m_buffer.
+    const char* m_data = nullptr;
+    // The size of the file contents in bytes.
+    size_t m_size = 0;
+    // The offset of the next line to read.
+    size_t m_cursor = 0;
+    // True when m_data is a memory mapping that must be unmapped.
+    bool m_mapped = false;
+    // How far m_data is into the mapping, which starts at a page boundary.
+    size_t m_map_offset = 0;
+    // Backing storage for files that can't be memory mapped, or are compressed.
+    std::vector<char> m_buffer;
+    Compression m_compression = Compression::NONE;
     // Count the lines in each file. They have to be the same.
-    long m_line_count = 0;
+    int64_t m_line_count = 0;
+    // The number of lines that end in a plain LF and in a CRLF.
+    int64_t m_lf_lines = 0;
+    int64_t m_crlf_lines = 0;
+    // The offset of every checkpoint line, to find lines quickly.
+    LineCheckpoints m_checkpoints;
+    // The hash, offset and length of every line, if it was built.
+    LineIndex m_line_index;
+    // Identifies this version of a regular file for the scan cache.
+    FileStamp m_stamp;
+    bool m_has_stamp = false;
+    // The 128-bit digest of the whole file.
+    uint64_t m_digest[2] = { 0, 0 };
+    bool m_has_digest = false;
     // Store the line ending information to use for this file.
     std::pair<std::string, const char*> m_line_ending;
     // Store the path/name of the file.
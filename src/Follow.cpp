@@ -0,0 +1,257 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Project includes.
+#include "Follow.h"
+#include "File.h"
+
+// System includes.
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+namespace AbeCmp {
+
+namespace {
+
+// The most verified bytes kept at the start and end of each file to tell a rewrite.
+const size_t verified_check_size = 64;
+
+// @brief True if the file still has bytes at offset.
+bool
+hasBytes(const std::string& name, uint64_t offset, const std::string& bytes)
+{
+    std::ifstream file(name, std::ios::in | std::ios::binary);
+    std::string read(bytes.size(), '\0');
+    return file.seekg(static_cast<std::streamoff>(offset)) && file.read(read.data(), static_cast<std::streamsize>(read.size())) && read == bytes;
+}
+
+// @brief The lines of a tail that have ended. The last line of a tail that
+//        doesn't end in a LF may still be being written.
+int64_t
+completeLines(const File& tail)
+{
+    const bool partial = tail.getSize() > 0 && tail.getData()[tail.getSize() - 1] != '\n';
+    return tail.getLineCount() - (partial ? 1 : 0);
+}
+
+} // namespace
+
+Follower::Follower(const FollowOptions& options)
+  : m_options(options)
+{
+}
+
+Follower::~Follower()
+{
+#if defined(__linux__)
+    if (m_inotify >= 0)
+        close(m_inotify);
+#endif
+}
+
+// @brief Start following both files. Their directories are watched too, so a
+//        rotated file that is created again under its name wakes wait().
+bool
+Follower::open(const std::string& name_a, const std::string& name_b)
+{
+    m_sides[0].name = name_a;
+    m_sides[1].name = name_b;
+    restart();
+#if defined(__linux__)
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify >= 0) {
+        for (const Side& side : m_sides) {
+            const std::filesystem::path dir = std::filesystem::path(side.name).parent_path();
+            inotify_add_watch(m_inotify, dir.empty() ? "." : dir.c_str(), IN_CREATE | IN_MOVED_TO);
+        }
+        addWatches();
+    }
+#endif
+    FileState state;
+    return statFile(name_a, state) && statFile(name_b, state);
+}
+
+bool
+Follower::statFile(const std::string& name, FileState& state)
+{
+#if defined(_WIN32)
+    std::error_code error;
+    state.size = std::filesystem::file_size(name, error);
+    state.inode = state.device = 0;
+    return !error;
+#else
+    struct stat st = {};
+    if (stat(name.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    state.size = static_cast<uint64_t>(st.st_size);
+    state.inode = static_cast<uint64_t>(st.st_ino);
+    state.device = static_cast<uint64_t>(st.st_dev);
+    return true;
+#endif
+}
+
+// @brief A file that is another file now, is shorter than what was verified,
+//        or whose last verified bytes changed, can't be picked up where it was left.
+std::string
+Follower::checkSide(const Side& side, const FileState& state) const
+{
+    if (side.known && (state.inode != side.inode || state.device != side.device))
+        return "was replaced";
+    if (state.size < side.offset)
+        return "got shorter";
+    if (side.offset > 0 && (!hasBytes(side.name, 0, side.verified_head) || !hasBytes(side.name, side.offset - side.verified_end.size(), side.verified_end)))
+        return "was rewritten";
+    return {};
+}
+
+void
+Follower::restart()
+{
+    for (Side& side : m_sides) {
+        side.offset = 0;
+        side.verified_head.clear();
+        side.verified_end.clear();
+    }
+    m_line = 0;
+}
+
+void
+Follower::addWatches()
+{
+#if defined(__linux__)
+    if (m_inotify < 0)
+        return;
+    // Both names may be the same file, which has one watch.
+    for (Side& side : m_sides) {
+        if (side.watch >= 0)
+            inotify_rm_watch(m_inotify, side.watch);
+        side.watch = -1;
+    }
+    for (Side& side : m_sides)
+        side.watch = inotify_add_watch(m_inotify, side.name.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF);
+#endif
+}
+
+// @brief Map the tail of each file past its verified lines and compare the
+//        lines that ended in both, from the first block that differs.
+bool
+Follower::update(const DiffHandler& handler, FollowUpdate& result)
+{
+    result = FollowUpdate();
+    FileState states[2];
+    if (!statFile(m_sides[0].name, states[0]) || !statFile(m_sides[1].name, states[1]))
+        // A rotated file that isn't there again yet.
+        return true;
+
+    bool replaced = false;
+    for (int i = 0; i < 2; ++i) {
+        Side& side = m_sides[i];
+        const std::string reason = checkSide(side, states[i]);
+        if (!reason.empty() && !result.rescan) {
+            result.rescan = true;
+            result.reason = std::string("File ") + (i == 0 ? "a " : "b ") + reason;
+        }
+        replaced |= side.known && (states[i].inode != side.inode || states[i].device != side.device);
+        side.inode = states[i].inode;
+        side.device = states[i].device;
+        side.known = true;
+    }
+    if (result.rescan)
+        restart();
+    if (replaced)
+        addWatches();
+
+    Side& side_a = m_sides[0];
+    Side& side_b = m_sides[1];
+    File tail_a, tail_b;
+    if (!tail_a.openTail(side_a.name, side_a.offset) || !tail_b.openTail(side_b.name, side_b.offset))
+        return false;
+    const int64_t count = std::min(completeLines(tail_a), completeLines(tail_b));
+    if (count == 0)
+        return true;
+
+    const bool le_differ = lineEndingsDiffer(tail_a, tail_b);
+    CompareOptions options = m_options.compare;
+    options.with_pretty_le = le_differ && !options.le_ignore;
+    const MatchPoint start = findFirstDifference(tail_a, tail_b, options.le_ignore && le_differ);
+    int64_t stop_line = count;
+    if (!start.identical && start.line < count) {
+        compareLines(tail_a, tail_b, start, count, options, [&](const LineDiff& diff) {
+            LineDiff numbered = diff;
+            numbered.line += m_line;
+            if (!handler(numbered)) {
+                result.stopped = true;
+                stop_line = diff.line;
+                return false;
+            }
+            ++result.line_diffs;
+            return true;
+        });
+    }
+    result.compared = stop_line;
+    if (result.stopped)
+        return true;
+
+    // Pick up after the last complete line next time.
+    for (int i = 0; i < 2; ++i) {
+        const File& tail = (i == 0) ? tail_a : tail_b;
+        Side& side = m_sides[i];
+        const size_t end = tail.findLine(count);
+        // Until the head is full, the tail starts right after it.
+        side.verified_head.append(tail.getData(), std::min(end, verified_check_size - side.verified_head.size()));
+        const size_t keep = std::min(end, verified_check_size);
+        side.verified_end.append(tail.getData() + end - keep, keep);
+        if (side.verified_end.size() > verified_check_size)
+            side.verified_end.erase(0, side.verified_end.size() - verified_check_size);
+        side.offset += end;
+    }
+    m_line += count;
+    return true;
+}
+
+// @brief Wait for an inotify event on either file or their directories. The
+//        events themselves are dropped: the next update looks at the files.
+void
+Follower::wait()
+{
+#if defined(__linux__)
+    if (m_inotify >= 0) {
+        pollfd poll_fd = { m_inotify, POLLIN, 0 };
+        if (poll(&poll_fd, 1, m_options.poll_interval_ms) > 0) {
+            char events[4096];
+            while (read(m_inotify, events, sizeof(events)) > 0) {
+            }
+        }
+        return;
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::milliseconds(m_options.poll_interval_ms));
+}
+
+} // namespace AbeCmp
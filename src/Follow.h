@@ -0,0 +1,128 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "Compare.h"
+
+// System includes.
+#include <cstdint>
+#include <string>
+
+namespace AbeCmp {
+
+// How to follow two growing files.
+struct FollowOptions
+{
+    CompareOptions compare;
+    // The longest wait for a change before the files are checked anyway, in
+    // milliseconds. Without inotify, the files are checked this often.
+    int poll_interval_ms = 1000;
+};
+
+// What one update of the followed files found.
+struct FollowUpdate
+{
+    // True if the files were compared from the start again, and why.
+    bool rescan = false;
+    std::string reason;
+    // The complete lines that both files gained and were compared, and how
+    // many of them differ.
+    int64_t compared = 0;
+    int64_t line_diffs = 0;
+    // True if the handler stopped the comparison.
+    bool stopped = false;
+};
+
+// Follows two files that grow, like a primary log and its replica, and compares
+// only the lines added since the last update. The byte offset of the first
+// unverified line in each file and its line number are kept, so an update maps
+// just the new tail of each file and runs the usual block skip and line
+// compare on it. A line is only compared once it ended in both files.
+// A file that got shorter, was replaced (rotated) or whose first or last
+// verified bytes changed is compared from the start again, along with the
+// other file. Changes elsewhere in the verified lines aren't looked for, as
+// that would mean reading them again.
+// On Linux, inotify wakes wait() when a file changes; elsewhere it polls.
+class Follower
+{
+  public:
+    explicit Follower(const FollowOptions& options);
+    ~Follower();
+    Follower(const Follower&) = delete;
+    Follower& operator=(const Follower&) = delete;
+
+    // Start following the files from their first line.
+    bool open(const std::string& name_a, const std::string& name_b);
+    // Compare the lines both files gained since the last update. The lines of
+    // the differences handed to the handler are numbered from the start of the
+    // files. Returns false if a file couldn't be read.
+    bool update(const DiffHandler& handler, FollowUpdate& result);
+    // Wait until either file changes, or for the poll interval at the most.
+    // A signal ends the wait early.
+    void wait();
+
+    // The number of lines verified so far, and where the next line starts in each file.
+    int64_t getLineCount() const { return m_line; }
+    uint64_t getOffsetA() const { return m_sides[0].offset; }
+    uint64_t getOffsetB() const { return m_sides[1].offset; }
+
+  private:
+    // The state of one followed file.
+    struct Side
+    {
+        std::string name;
+        // The file the name pointed to when it was last compared.
+        uint64_t inode = 0;
+        uint64_t device = 0;
+        bool known = false;
+        // The byte offset of the first line that wasn't verified.
+        uint64_t offset = 0;
+        // The first and last verified bytes, to tell a file that was rewritten in place.
+        std::string verified_head;
+        std::string verified_end;
+        // The inotify watch of the file.
+        int watch = -1;
+    };
+
+    // The size and identity of a file on disk.
+    struct FileState
+    {
+        uint64_t size = 0;
+        uint64_t inode = 0;
+        uint64_t device = 0;
+    };
+
+    // Get the state of a file. Returns false if it isn't there (for now).
+    static bool statFile(const std::string& name, FileState& state);
+    // Check a file for truncation, replacement or a rewrite. Returns why the
+    // files must be compared from the start again, or an empty string.
+    std::string checkSide(const Side& side, const FileState& state) const;
+    // Start over from the first line of both files.
+    void restart();
+    // Watch both files again, after either of them was replaced.
+    void addWatches();
+
+  private:
+    FollowOptions m_options;
+    Side m_sides[2];
+    int64_t m_line = 0;
+    int m_inotify = -1;
+};
+
+} // namespace AbeCmp
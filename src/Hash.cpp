@@ -0,0 +1,76 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "Hash.h"
+
+// System includes.
+#include <cstring>
+
+namespace AbeCmp {
+
+namespace {
+
+const uint64_t prime_1 = 0x9E3779B185EBCA87ull;
+const uint64_t prime_2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t prime_3 = 0x165667B19E3779F9ull;
+
+inline uint64_t
+rotl(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+// @brief Load 8 bytes without caring about alignment.
+inline uint64_t
+load64(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// @brief Spread every input bit over the whole result (the murmur3 finalizer).
+inline uint64_t
+avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= prime_2;
+    h ^= h >> 29;
+    h *= prime_3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace
+
+uint64_t
+hashBytes(const char* data, size_t size, uint64_t seed)
+{
+    uint64_t h = seed ^ (prime_1 * (size + 1));
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+        h = rotl(h ^ (load64(data + i) * prime_2), 31) * prime_1;
+
+    // Fold in the last 0 to 7 bytes.
+    uint64_t tail = 0;
+    if (i < size)
+        memcpy(&tail, data + i, size - i);
+    h = rotl(h ^ (tail * prime_3), 27) * prime_1;
+    return avalanche(h);
+}
+
+} // namespace AbeCmp
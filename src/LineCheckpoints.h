@@ -0,0 +1,73 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// System includes.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace AbeCmp {
+
+// A sparse index of a file: the byte offset of the start of every interval-th
+// line. It is filled by the line scan, and any line is found from the nearest
+// checkpoint before it without scanning from the start of the file.
+class LineCheckpoints
+{
+  public:
+    // Lines between two checkpoints.
+    static constexpr int64_t default_interval = 4096;
+
+    explicit LineCheckpoints(int64_t interval = default_interval)
+      : m_interval(interval)
+    {
+        clear();
+    }
+    // Drop all checkpoints but the one of the first line.
+    void clear()
+    {
+        m_offsets.assign(1, 0);
+    }
+    // Take over complete offsets, starting with the one of the first line.
+    void assign(int64_t interval, std::vector<uint64_t> offsets)
+    {
+        m_interval = interval;
+        m_offsets = std::move(offsets);
+        if (m_offsets.empty())
+            m_offsets.assign(1, 0);
+    }
+    // Add the offset of the next checkpoint line.
+    void add(uint64_t offset) { m_offsets.push_back(offset); }
+    void reserve(size_t count) { m_offsets.reserve(count); }
+    int64_t getInterval() const { return m_interval; }
+    // The zero based line of the last checkpoint at or before line.
+    int64_t getCheckpointLine(int64_t line) const { return std::min<int64_t>(line / m_interval, size() - 1) * m_interval; }
+    // The byte offset of the start of the line returned by getCheckpointLine().
+    uint64_t getCheckpointOffset(int64_t line) const { return m_offsets[static_cast<size_t>(getCheckpointLine(line) / m_interval)]; }
+    int64_t size() const { return static_cast<int64_t>(m_offsets.size()); }
+    const std::vector<uint64_t>& getOffsets() const { return m_offsets; }
+
+  private:
+    int64_t m_interval;
+    // The offset of the start of line k * m_interval at index k.
+    std::vector<uint64_t> m_offsets;
+};
+
+} // namespace AbeCmp
@@ -0,0 +1,75 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// System includes.
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace AbeCmp {
+
+// A per line index of a file: the hash, byte offset and length of every line.
+// The length doesn't include the line ending. The index never refers to the
+// file contents, so it stays valid when the contents are no longer mapped.
+class LineIndex
+{
+  public:
+    void clear()
+    {
+        m_hashes.clear();
+        m_offsets.clear();
+        m_lengths.clear();
+    }
+    void reserve(size_t lines)
+    {
+        m_hashes.reserve(lines);
+        m_offsets.reserve(lines);
+        m_lengths.reserve(lines);
+    }
+    // Take over complete arrays, all of the same size.
+    void assign(std::vector<uint64_t> hashes, std::vector<uint64_t> offsets, std::vector<uint32_t> lengths)
+    {
+        m_hashes = std::move(hashes);
+        m_offsets = std::move(offsets);
+        m_lengths = std::move(lengths);
+    }
+    void add(uint64_t hash, uint64_t offset, uint32_t length)
+    {
+        m_hashes.push_back(hash);
+        m_offsets.push_back(offset);
+        m_lengths.push_back(length);
+    }
+    bool empty() const { return m_hashes.empty(); }
+    int64_t size() const { return static_cast<int64_t>(m_hashes.size()); }
+    uint64_t getHash(int64_t line) const { return m_hashes[line]; }
+    uint64_t getOffset(int64_t line) const { return m_offsets[line]; }
+    uint32_t getLength(int64_t line) const { return m_lengths[line]; }
+    const std::vector<uint64_t>& getHashes() const { return m_hashes; }
+    const std::vector<uint64_t>& getOffsets() const { return m_offsets; }
+    const std::vector<uint32_t>& getLengths() const { return m_lengths; }
+
+  private:
+    // Kept as separate arrays so a hash only pass touches 8 bytes per line.
+    std::vector<uint64_t> m_hashes;
+    std::vector<uint64_t> m_offsets;
+    std::vector<uint32_t> m_lengths;
+};
+
+} // namespace AbeCmp
@@ -0,0 +1,123 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "File.h"
+
+// System includes.
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace AbeCmp {
+
+// Walks the lines of an open file as views into its contents, so no line is
+// copied or allocated. A view drops the line ending (and the CR of a CRLF
+// ending) and stays valid until the file is closed.
+class LineIterator
+{
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view*;
+    using reference = const std::string_view&;
+
+    LineIterator() = default;
+    // Start at the line that begins at offset; an offset at the end of the file is the end iterator.
+    LineIterator(const File& file, size_t offset)
+      : m_file(&file)
+      , m_next(offset)
+    {
+        advance();
+    }
+
+    reference operator*() const { return m_line; }
+    pointer operator->() const { return &m_line; }
+    LineIterator& operator++()
+    {
+        advance();
+        return *this;
+    }
+    LineIterator operator++(int)
+    {
+        LineIterator previous = *this;
+        advance();
+        return previous;
+    }
+    bool operator==(const LineIterator& other) const { return m_offset == other.m_offset && m_file == other.m_file; }
+    bool operator!=(const LineIterator& other) const { return !(*this == other); }
+
+    // The byte offset where the current line starts.
+    size_t getOffset() const { return m_offset; }
+
+  private:
+    void advance()
+    {
+        m_offset = m_next;
+        if (m_offset >= m_file->getSize()) {
+            m_offset = m_file->getSize();
+            m_line = {};
+        } else {
+            m_line = m_file->getLine(m_next);
+        }
+    }
+
+  private:
+    const File* m_file = nullptr;
+    // The offsets of the current and the next line.
+    size_t m_offset = 0;
+    size_t m_next = 0;
+    std::string_view m_line;
+};
+
+// The lines of a file from a byte offset on, for range based for loops:
+//     for (std::string_view line : lines(file))
+class LineRange
+{
+  public:
+    LineRange(const File& file, size_t offset)
+      : m_file(&file)
+      , m_offset(offset)
+    {
+    }
+
+    LineIterator begin() const { return LineIterator(*m_file, m_offset); }
+    LineIterator end() const { return LineIterator(*m_file, m_file->getSize()); }
+
+  private:
+    const File* m_file;
+    size_t m_offset;
+};
+
+// All lines of a file, or the lines from the one that starts at a byte offset.
+inline LineRange
+lines(const File& file, size_t offset = 0)
+{
+    return LineRange(file, offset);
+}
+
+// The lines of a file from a zero based line number on.
+inline LineRange
+linesFrom(const File& file, int64_t first_line)
+{
+    return LineRange(file, file.findLine(first_line));
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,148 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Project includes.
+#include "Normalize.h"
+#include "Hash.h"
+#include "Scanner.h"
+
+// System includes.
+#include <algorithm>
+
+namespace AbeCmp {
+
+namespace {
+
+// @brief Return true for the white space that the normalizations skip.
+//        The CR of a CRLF line counts as white space, as it does for diff.
+inline bool
+isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// @brief Return true if everything from pos on is white space.
+bool
+onlySpaceFrom(std::string_view s, size_t pos)
+{
+    return std::all_of(s.begin() + static_cast<std::ptrdiff_t>(pos), s.end(), isSpace);
+}
+
+// @brief Skip the white space that starts at pos.
+size_t
+skipSpace(std::string_view s, size_t pos)
+{
+    while (pos < s.size() && isSpace(s[pos]))
+        ++pos;
+    return pos;
+}
+
+} // namespace
+
+// @brief Compare two lines under the normalization.
+//        The equal prefix of both lines is found with the vector mismatch kernel,
+//        folding case when asked. Only at a mismatch are the white space rules
+//        applied, after which the kernel takes over again.
+bool
+equalNormalized(std::string_view a, std::string_view b, const Normalization& normalization)
+{
+    const bool trailing = normalization.ignore_trailing_space || normalization.ignore_space_change || normalization.ignore_all_space;
+    size_t i = 0;
+    size_t j = 0;
+    for (;;) {
+        const size_t n = std::min(a.size() - i, b.size() - j);
+        const size_t same = findLineMismatch(a.data() + i, b.data() + j, n, normalization.ignore_case);
+        i += same;
+        j += same;
+        if (i == a.size() && j == b.size())
+            return true;
+
+        const bool space_a = i < a.size() && isSpace(a[i]);
+        const bool space_b = j < b.size() && isSpace(b[j]);
+        if (normalization.ignore_all_space && (space_a || space_b)) {
+            i = skipSpace(a, i);
+            j = skipSpace(b, j);
+            continue;
+        }
+        if (normalization.ignore_space_change) {
+            // Both sides must be inside a run of white space for the runs to
+            // match; a run that is present on one side only is a change.
+            const bool run_a = space_a || (i > 0 && isSpace(a[i - 1]) && space_b);
+            const bool run_b = space_b || (j > 0 && isSpace(b[j - 1]) && space_a);
+            if (run_a && run_b && (space_a || space_b)) {
+                i = skipSpace(a, i);
+                j = skipSpace(b, j);
+                if (i < a.size() || j < b.size())
+                    continue;
+                return true;
+            }
+        }
+        return trailing && onlySpaceFrom(a, i) && onlySpaceFrom(b, j);
+    }
+}
+
+// @brief Hash a line under the normalization.
+//        The line is normalized into scratch in the same terms as equalNormalized():
+//        case is folded, trailing white space is dropped, and white space runs are
+//        dropped or squeezed to one blank.
+uint64_t
+hashNormalized(std::string_view line, const Normalization& normalization, std::string& scratch)
+{
+    const bool trailing = normalization.ignore_trailing_space || normalization.ignore_space_change || normalization.ignore_all_space;
+    size_t end = line.size();
+    if (trailing) {
+        while (end > 0 && isSpace(line[end - 1]))
+            --end;
+    }
+
+    scratch.clear();
+    for (size_t i = 0; i < end;) {
+        const char c = line[i];
+        if (isSpace(c) && (normalization.ignore_all_space || normalization.ignore_space_change)) {
+            i = skipSpace(line, i);
+            if (!normalization.ignore_all_space)
+                scratch += ' ';
+            continue;
+        }
+        scratch += (normalization.ignore_case && c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+        ++i;
+    }
+    return hashBytes(scratch.data(), scratch.size());
+}
+
+// @brief Describe what the normalization ignores.
+std::string
+describeNormalization(const Normalization& normalization)
+{
+    std::string text;
+    auto add = [&text](const char* what) {
+        if (!text.empty())
+            text += ", ";
+        text += what;
+    };
+    if (normalization.ignore_all_space)
+        add("all white space");
+    else if (normalization.ignore_space_change)
+        add("changes in the amount of white space");
+    else if (normalization.ignore_trailing_space)
+        add("trailing white space");
+    if (normalization.ignore_case)
+        add("case differences");
+    return text;
+}
+
+} // namespace AbeCmp
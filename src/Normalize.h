@@ -0,0 +1,55 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// System includes.
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace AbeCmp {
+
+// Differences between lines that don't count. Several can be combined.
+struct Normalization
+{
+    // Runs of white space of any length match each other (diff -b).
+    bool ignore_space_change = false;
+    // White space doesn't matter at all (diff -w).
+    bool ignore_all_space = false;
+    // White space at the end of a line doesn't matter (diff -Z).
+    bool ignore_trailing_space = false;
+    // ASCII letters match either case (diff -i).
+    bool ignore_case = false;
+
+    // True if any difference is ignored.
+    bool any() const { return ignore_space_change || ignore_all_space || ignore_trailing_space || ignore_case; }
+};
+
+// Compare two lines under the normalization, in one pass over both lines
+// without making normalized copies of them.
+bool equalNormalized(std::string_view a, std::string_view b, const Normalization& normalization);
+
+// Hash a line under the normalization, so that lines that are equal under
+// it hash the same. The normalized line is built in scratch, which callers
+// reuse across lines to save allocations.
+uint64_t hashNormalized(std::string_view line, const Normalization& normalization, std::string& scratch);
+
+// Describe what the normalization ignores, e.g. "trailing white space, case differences".
+std::string describeNormalization(const Normalization& normalization);
+
+} // namespace AbeCmp
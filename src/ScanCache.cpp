@@ -0,0 +1,306 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "ScanCache.h"
+#include "Hash.h"
+
+// System includes.
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string_view>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace AbeCmp {
+
+namespace {
+
+// Identifies an entry file and its layout version.
+const char entry_magic[8] = { 'A', 'B', 'E', 'C', 'M', 'P', 'S', '3' };
+
+// Makes temporary entry names unique across processes and threads.
+const unsigned long process_token = std::random_device{}();
+std::atomic<unsigned long> temp_counter{ 0 };
+
+template<typename T>
+void
+put(std::ofstream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+void
+putVector(std::ofstream& out, const std::vector<T>& values)
+{
+    put(out, static_cast<uint64_t>(values.size()));
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template<typename T>
+bool
+get(std::ifstream& in, T& value)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+// @brief The bytes between the read position and the end of the entry.
+uint64_t
+getBytesLeft(std::ifstream& in)
+{
+    const std::streampos pos = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streampos end = in.tellg();
+    in.seekg(pos);
+    return (pos < 0 || end < pos) ? 0 : static_cast<uint64_t>(end - pos);
+}
+
+// @brief A count that doesn't fit in the rest of the entry means the entry is
+//        corrupt or foreign, so it fails the read instead of the allocation.
+template<typename T>
+bool
+getVector(std::ifstream& in, std::vector<T>& values)
+{
+    uint64_t count = 0;
+    if (!get(in, count) || count > getBytesLeft(in) / sizeof(T))
+        return false;
+    values.resize(count);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(count * sizeof(T))));
+}
+
+template<typename T>
+bool
+skipVector(std::ifstream& in)
+{
+    uint64_t count = 0;
+    if (!get(in, count) || count > getBytesLeft(in) / sizeof(T))
+        return false;
+    return static_cast<bool>(in.seekg(static_cast<std::streamoff>(count * sizeof(T)), std::ios::cur));
+}
+
+// @brief The counts and checkpoints must fit together the way a scan leaves them:
+//        a checkpoint every interval lines from offset 0 on, in file order. A
+//        file that doesn't end in a newline has one line without a line ending,
+//        and no checkpoint after it when its line count is a multiple of the
+//        interval. The offsets are checked against the contents by File, since
+//        those of a compressed file go past the size on disk.
+bool
+checkCounts(int64_t line_count, const int64_t le_lines[2], int64_t interval, const std::vector<uint64_t>& checkpoints)
+{
+    if (line_count < 0 || le_lines[0] < 0 || le_lines[1] < 0 || interval <= 0)
+        return false;
+    const int64_t ended = le_lines[0] + le_lines[1];
+    if (ended != line_count && ended != line_count - 1)
+        return false;
+    const uint64_t count = static_cast<uint64_t>(line_count / interval) + 1;
+    const bool last_unterminated = (ended < line_count && line_count % interval == 0);
+    if (checkpoints.size() != count && !(last_unterminated && checkpoints.size() == count - 1))
+        return false;
+    if (checkpoints.empty() || checkpoints[0] != 0)
+        return false;
+    return std::is_sorted(checkpoints.begin(), checkpoints.end());
+}
+
+} // namespace
+
+bool
+ScanCache::init()
+{
+    if (m_dir.empty())
+        return true;
+    std::error_code ec;
+    fs::create_directories(m_dir, ec);
+    return fs::is_directory(m_dir, ec);
+}
+
+void
+ScanCache::keepInMemory(size_t max_entries, bool memory_only)
+{
+    m_memory_entries = max_entries;
+    m_memory_only = memory_only;
+}
+
+// @brief Entries are keyed by the absolute path, so relative names from different
+//        working directories don't share an entry.
+std::string
+ScanCache::entryKey(const std::string& path) const
+{
+    std::error_code ec;
+    const fs::path absolute = fs::absolute(path, ec);
+    return ec ? path : absolute.lexically_normal().string();
+}
+
+bool
+ScanCache::isSidecar(const std::string& path)
+{
+    const std::string_view suffix = sidecar_suffix;
+    return path.size() > suffix.size() && path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// @brief Entries in the cache directory are named by the hash of their key;
+//        entries kept next to their file are named after it.
+std::string
+ScanCache::entryPath(const std::string& key) const
+{
+    if (m_dir.empty())
+        return key + sidecar_suffix;
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.scan", static_cast<unsigned long long>(hashBytes(key.data(), key.size())));
+    return (fs::path(m_dir) / name).string();
+}
+
+// @brief Look up the entry of a path in memory, then on disk. An entry read
+//        from disk is kept in memory too. An entry too large to load is a miss.
+bool
+ScanCache::lookup(const std::string& path, const FileStamp& stamp, bool with_line_index, ScanEntry& entry) const
+{
+    const std::string key = entryKey(path);
+    if (m_memory_entries > 0) {
+        std::lock_guard<std::mutex> lock(m_memory_mutex);
+        const auto it = m_memory.find(key);
+        if (it != m_memory.end() && it->second.stamp == stamp && (!with_line_index || !it->second.line_index.empty())) {
+            entry = it->second;
+            return true;
+        }
+    }
+    if (m_memory_only)
+        return false;
+    try {
+        if (!readEntry(key, stamp, with_line_index, entry))
+            return false;
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    if (m_memory_entries > 0)
+        remember(key, entry);
+    return true;
+}
+
+// @brief Add an entry in memory, and drop the oldest entries past the limit.
+void
+ScanCache::remember(const std::string& key, const ScanEntry& entry) const
+{
+    std::lock_guard<std::mutex> lock(m_memory_mutex);
+    const auto [it, added] = m_memory.insert_or_assign(key, entry);
+    if (!added)
+        return;
+    m_memory_order.push_back(key);
+    while (m_memory.size() > m_memory_entries) {
+        m_memory.erase(m_memory_order.front());
+        m_memory_order.pop_front();
+    }
+}
+
+// @brief Read the entry file of a key. The stored path and stamp must both
+//        match, so a hash collision or a changed file is treated as a miss. A
+//        line index that wasn't stored makes the lookup miss when
+//        with_line_index is set. So does an entry whose counts don't fit
+//        together, which the line functions would otherwise run past the
+//        contents with.
+bool
+ScanCache::readEntry(const std::string& key, const FileStamp& stamp, bool with_line_index, ScanEntry& entry) const
+{
+    std::ifstream in(entryPath(key), std::ios::in | std::ios::binary);
+    if (!in.is_open())
+        return false;
+
+    char magic[sizeof(entry_magic)];
+    std::vector<char> stored_path;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), entry_magic))
+        return false;
+    if (!getVector(in, stored_path) || std::string(stored_path.begin(), stored_path.end()) != key)
+        return false;
+    if (!get(in, entry.stamp) || !(entry.stamp == stamp))
+        return false;
+
+    uint8_t crlf = 0;
+    int64_t line_count = 0;
+    int64_t le_lines[2] = { 0, 0 };
+    if (!get(in, crlf) || !get(in, line_count) || !get(in, le_lines) || !get(in, entry.checkpoint_interval) || !getVector(in, entry.checkpoints) || !get(in, entry.digest))
+        return false;
+    if (!checkCounts(line_count, le_lines, entry.checkpoint_interval, entry.checkpoints))
+        return false;
+    entry.crlf = (crlf != 0);
+    entry.line_count = line_count;
+    entry.lf_lines = le_lines[0];
+    entry.crlf_lines = le_lines[1];
+
+    // Leave a stored line index on disk unless it is wanted.
+    if (!with_line_index)
+        return skipVector<uint64_t>(in) && skipVector<uint64_t>(in) && skipVector<uint32_t>(in);
+
+    std::vector<uint64_t> hashes, offsets;
+    std::vector<uint32_t> lengths;
+    if (!getVector(in, hashes) || !getVector(in, offsets) || !getVector(in, lengths))
+        return false;
+    if (hashes.empty() || hashes.size() != static_cast<uint64_t>(line_count) || hashes.size() != offsets.size() || hashes.size() != lengths.size())
+        return false;
+    entry.line_index.assign(std::move(hashes), std::move(offsets), std::move(lengths));
+    return true;
+}
+
+// @brief Write the entry to a temporary file and rename it into place, so readers
+//        never see a half written entry.
+bool
+ScanCache::store(const std::string& path, const ScanEntry& entry) const
+{
+    const std::string key = entryKey(path);
+    if (m_memory_entries > 0)
+        remember(key, entry);
+    if (m_memory_only)
+        return true;
+    const std::string final_path = entryPath(key);
+    const std::string temp_path = final_path + ".tmp" + std::to_string(process_token) + "-" + std::to_string(temp_counter++);
+    {
+        std::ofstream out(temp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+        out.write(entry_magic, sizeof(entry_magic));
+        putVector(out, std::vector<char>(key.begin(), key.end()));
+        put(out, entry.stamp);
+        put(out, static_cast<uint8_t>(entry.crlf ? 1 : 0));
+        put(out, entry.line_count);
+        const int64_t le_lines[2] = { entry.lf_lines, entry.crlf_lines };
+        put(out, le_lines);
+        put(out, entry.checkpoint_interval);
+        putVector(out, entry.checkpoints);
+        put(out, entry.digest);
+        putVector(out, entry.line_index.getHashes());
+        putVector(out, entry.line_index.getOffsets());
+        putVector(out, entry.line_index.getLengths());
+        if (!out.good()) {
+            out.close();
+            std::remove(temp_path.c_str());
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp_path, final_path, ec);
+    if (ec) {
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,114 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "LineCheckpoints.h"
+#include "LineIndex.h"
+
+// System includes.
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace AbeCmp {
+
+// Identifies one version of a file. If any field changes, the file is scanned again.
+struct FileStamp
+{
+    uint64_t size = 0;
+    int64_t mtime_ns = 0;
+    uint64_t inode = 0;
+    uint64_t device = 0;
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+// What a scan found out about a file.
+struct ScanEntry
+{
+    FileStamp stamp;
+    // True if the first line ends in a CRLF, false for LF.
+    bool crlf = false;
+    int64_t line_count = 0;
+    // The number of lines that end in a plain LF and in a CRLF.
+    int64_t lf_lines = 0;
+    int64_t crlf_lines = 0;
+    // The offset of every checkpoint line, one every checkpoint_interval lines.
+    int64_t checkpoint_interval = LineCheckpoints::default_interval;
+    std::vector<uint64_t> checkpoints;
+    // A 128-bit digest of the whole file.
+    uint64_t digest[2] = { 0, 0 };
+    // The per line hash index, if it was built.
+    LineIndex line_index;
+};
+
+// An opt-in, on-disk cache of scan results with one entry file per path.
+// An entry is only used while the size, mtime and inode of the file are unchanged.
+// With an empty directory, each entry is kept next to its file instead, as the
+// file name plus sidecar_suffix. A long running process can keep the latest
+// entries in memory too, in front of the disk, or in memory only.
+class ScanCache
+{
+  public:
+    static constexpr const char* sidecar_suffix = ".abeidx";
+
+    explicit ScanCache(const std::string& dir)
+      : m_dir(dir)
+    {
+    }
+
+    // Create the cache directory. Returns false if it can't be used.
+    bool init();
+    // Keep up to max_entries entries in memory as well, the oldest going first.
+    // With memory_only, entries are neither read from nor written to disk.
+    // Call before the cache is shared by threads.
+    void keepInMemory(size_t max_entries, bool memory_only);
+    // True if path names an entry kept next to its file.
+    static bool isSidecar(const std::string& path);
+    // Load the entry for path if it matches the stamp, with or without the line index.
+    bool lookup(const std::string& path, const FileStamp& stamp, bool with_line_index, ScanEntry& entry) const;
+    // Write the entry for path, replacing an older one.
+    bool store(const std::string& path, const ScanEntry& entry) const;
+    const std::string& getDir() const { return m_dir; }
+
+  private:
+    // The normalized absolute path that an entry is stored under.
+    std::string entryKey(const std::string& path) const;
+    // The entry file that belongs to a key.
+    std::string entryPath(const std::string& key) const;
+    // Read the entry file of a key, if it matches the stamp.
+    bool readEntry(const std::string& key, const FileStamp& stamp, bool with_line_index, ScanEntry& entry) const;
+    // Add or replace the entry of a key in memory.
+    void remember(const std::string& key, const ScanEntry& entry) const;
+
+  private:
+    std::string m_dir;
+    // The entries kept in memory and the order they were added in. Lookups
+    // from several threads share them.
+    size_t m_memory_entries = 0;
+    bool m_memory_only = false;
+    mutable std::mutex m_memory_mutex;
+    mutable std::unordered_map<std::string, ScanEntry> m_memory;
+    mutable std::deque<std::string> m_memory_order;
+};
+
+} // namespace AbeCmp
@@ -0,0 +1,405 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "Scanner.h"
+
+// System includes.
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define ABECMP_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace AbeCmp {
+
+namespace {
+
+// Compare this many bytes with memcmp before looking for the exact mismatch.
+const size_t mismatch_block_size = 64 * 1024;
+
+// Running state carried from one block of the sweep to the next.
+struct ScanState
+{
+    int64_t lf_count = 0;
+    int64_t crlf_count = 0;
+    size_t first_lf = 0;
+    bool first_is_crlf = false;
+    bool found_lf = false;
+    // True if the last byte of the previous block was a CR.
+    bool prev_cr = false;
+    // Where to add checkpoints, if anywhere, and the file offset of the data.
+    LineCheckpoints* checkpoints = nullptr;
+    uint64_t base = 0;
+    // The LF count (in this sweep) after which the next checkpoint line starts.
+    int64_t next_checkpoint = 0;
+};
+
+// @brief Add the checkpoint lines that start after the LFs of a mask. Only called
+//        for the rare masks that reach the next checkpoint, so the hot loop pays
+//        a single compare for checkpoints.
+void
+addCheckpoints(uint64_t lf_mask, size_t base, ScanState& st)
+{
+    int64_t seen = st.lf_count;
+    for (; lf_mask != 0; lf_mask &= lf_mask - 1) {
+        if (++seen == st.next_checkpoint) {
+            st.checkpoints->add(st.base + base + std::countr_zero(lf_mask) + 1);
+            st.next_checkpoint += st.checkpoints->getInterval();
+        }
+    }
+}
+
+// @brief Fold the LF and CR bit masks of a block of width bytes into the state.
+//        A LF is part of a CRLF pair when the byte before it is a CR, which may
+//        be the last byte of the previous block.
+inline void
+addMasks(uint64_t lf_mask, uint64_t cr_mask, unsigned width, size_t base, ScanState& st)
+{
+    const uint64_t crlf_mask = lf_mask & ((cr_mask << 1) | (st.prev_cr ? 1u : 0u));
+    st.prev_cr = (cr_mask >> (width - 1)) & 1u;
+    if (lf_mask == 0)
+        return;
+
+    const long lf_count = std::popcount(lf_mask);
+    if (st.checkpoints != nullptr && st.lf_count + lf_count >= st.next_checkpoint)
+        addCheckpoints(lf_mask, base, st);
+    st.lf_count += lf_count;
+    st.crlf_count += std::popcount(crlf_mask);
+    if (!st.found_lf) {
+        const unsigned bit = std::countr_zero(lf_mask);
+        st.first_lf = base + bit;
+        st.first_is_crlf = (crlf_mask >> bit) & 1u;
+        st.found_lf = true;
+    }
+}
+
+// @brief Scan one byte at a time starting at begin.
+//        Used for hosts without SIMD and for the tail of the vectorized kernels.
+void
+scanScalar(const char* data, size_t begin, size_t size, ScanState& st)
+{
+    for (size_t i = begin; i < size; ++i) {
+        const char c = data[i];
+        if (c == '\n') {
+            ++st.lf_count;
+            if (st.checkpoints != nullptr && st.lf_count == st.next_checkpoint) {
+                st.checkpoints->add(st.base + i + 1);
+                st.next_checkpoint += st.checkpoints->getInterval();
+            }
+            if (st.prev_cr)
+                ++st.crlf_count;
+            if (!st.found_lf) {
+                st.first_lf = i;
+                st.first_is_crlf = st.prev_cr;
+                st.found_lf = true;
+            }
+        }
+        st.prev_cr = (c == '\r');
+    }
+}
+
+#if defined(ABECMP_X86_SIMD)
+
+// @brief Scan 64 bytes per iteration with four SSE2 compares per character class.
+//        Returns the offset of the first byte that was not scanned.
+__attribute__((target("sse2"))) size_t
+scanSse2(const char* data, size_t size, ScanState& st)
+{
+    const __m128i lf = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        uint64_t lf_mask = 0;
+        uint64_t cr_mask = 0;
+        for (unsigned k = 0; k < 4; ++k) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16 * k));
+            lf_mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, lf)))) << (16 * k);
+            cr_mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, cr)))) << (16 * k);
+        }
+        addMasks(lf_mask, cr_mask, 64, i, st);
+    }
+    return i;
+}
+
+// @brief Scan 64 bytes per iteration with two AVX2 compares per character class.
+//        Returns the offset of the first byte that was not scanned.
+__attribute__((target("avx2,popcnt,bmi"))) size_t
+scanAvx2(const char* data, size_t size, ScanState& st)
+{
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32));
+        const uint64_t lf_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, lf))) |
+                                 (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, lf)))) << 32);
+        const uint64_t cr_mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, cr))) |
+                                 (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, cr)))) << 32);
+        addMasks(lf_mask, cr_mask, 64, i, st);
+    }
+    return i;
+}
+
+// @brief Find the first differing byte 32 bytes at a time with AVX2.
+//        Returns the offset of the mismatch, or the offset of the first byte
+//        that was not compared.
+__attribute__((target("avx2,bmi"))) size_t
+mismatchAvx2(const char* a, const char* b, size_t size)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        const uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (eq != 0xFFFFFFFFu)
+            return i + std::countr_zero(~eq);
+    }
+    return i;
+}
+
+// @brief Find the first differing byte 16 bytes at a time with SSE2.
+__attribute__((target("sse2"))) size_t
+mismatchSse2(const char* a, const char* b, size_t size)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const uint32_t eq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+        if (eq != 0xFFFFu)
+            return i + std::countr_zero(~eq);
+    }
+    return i;
+}
+
+// @brief Load 32 bytes and fold ASCII upper case letters to lower case.
+//        Upper case letters are found with two signed compares, which leave
+//        bytes above 0x7f alone, and get the 0x20 bit set.
+__attribute__((target("avx2"))) inline __m256i
+foldAvx2(const char* data)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    return _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+// @brief Find the first differing byte after ASCII case folding, 32 bytes at a time with AVX2.
+__attribute__((target("avx2,bmi"))) size_t
+mismatchFoldedAvx2(const char* a, const char* b, size_t size)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        const __m256i va = foldAvx2(a + i);
+        const __m256i vb = foldAvx2(b + i);
+        const uint32_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+        if (eq != 0xFFFFFFFFu)
+            return i + std::countr_zero(~eq);
+    }
+    return i;
+}
+
+// @brief Load 16 bytes and fold ASCII upper case letters to lower case.
+__attribute__((target("sse2"))) inline __m128i
+foldSse2(const char* data)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+// @brief Find the first differing byte after ASCII case folding, 16 bytes at a time with SSE2.
+__attribute__((target("sse2"))) size_t
+mismatchFoldedSse2(const char* a, const char* b, size_t size)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i va = foldSse2(a + i);
+        const __m128i vb = foldSse2(b + i);
+        const uint32_t eq = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+        if (eq != 0xFFFFu)
+            return i + std::countr_zero(~eq);
+    }
+    return i;
+}
+
+// @brief Count the differing bytes 64 at a time with AVX2.
+//        Stores the offset of the first byte that was not looked at in done.
+__attribute__((target("avx2,popcnt"))) size_t
+countMismatchesAvx2(const char* a, const char* b, size_t size, size_t& done)
+{
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 64 <= size; i += 64) {
+        const __m256i lo = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        const __m256i hi = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32)));
+        const uint64_t eq = static_cast<uint32_t>(_mm256_movemask_epi8(lo)) | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hi))) << 32);
+        count += static_cast<size_t>(std::popcount(~eq));
+    }
+    done = i;
+    return count;
+}
+
+// @brief Count the differing bytes 16 at a time with SSE2.
+__attribute__((target("sse2"))) size_t
+countMismatchesSse2(const char* a, const char* b, size_t size, size_t& done)
+{
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+        count += static_cast<size_t>(std::popcount(static_cast<uint32_t>(~_mm_movemask_epi8(eq) & 0xFFFF)));
+    }
+    done = i;
+    return count;
+}
+
+#endif // ABECMP_X86_SIMD
+
+// @brief Fold an ASCII upper case letter to lower case.
+inline char
+foldCase(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+// A vectorized kernel scans a prefix of the data and returns where it stopped.
+using ScanKernel = size_t (*)(const char*, size_t, ScanState&);
+// A vectorized kernel that returns the first mismatch or where it stopped.
+using MismatchKernel = size_t (*)(const char*, const char*, size_t);
+// Counts differing bytes and stores the offset of the first byte it didn't look at.
+using CountKernel = size_t (*)(const char*, const char*, size_t, size_t&);
+
+struct KernelInfo
+{
+    ScanKernel kernel;
+    MismatchKernel mismatch;
+    MismatchKernel mismatch_folded;
+    CountKernel count_mismatches;
+    const char* name;
+};
+
+// @brief Pick the best kernel for this host once, on first use.
+const KernelInfo&
+selectKernel()
+{
+    static const KernelInfo info = []() -> KernelInfo {
+#if defined(ABECMP_X86_SIMD)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return { scanAvx2, mismatchAvx2, mismatchFoldedAvx2, countMismatchesAvx2, "avx2" };
+        if (__builtin_cpu_supports("sse2"))
+            return { scanSse2, mismatchSse2, mismatchFoldedSse2, countMismatchesSse2, "sse2" };
+#endif
+        return { nullptr, nullptr, nullptr, nullptr, "scalar" };
+    }();
+    return info;
+}
+
+} // namespace
+
+ScanResult
+scanLines(const char* data, size_t size, LineCheckpoints* checkpoints, uint64_t base, int64_t lines_before)
+{
+    ScanState st;
+    if (checkpoints != nullptr) {
+        // The first checkpoint line after the lines that came before the data.
+        const int64_t interval = checkpoints->getInterval();
+        st.checkpoints = checkpoints;
+        st.base = base;
+        st.next_checkpoint = (lines_before / interval + 1) * interval - lines_before;
+    }
+    size_t done = 0;
+    if (const ScanKernel kernel = selectKernel().kernel)
+        done = kernel(data, size, st);
+    scanScalar(data, done, size, st);
+
+    ScanResult result;
+    result.lf_count = st.lf_count;
+    result.crlf_count = st.crlf_count;
+    // A last line without a line ending still counts as a line.
+    result.line_count = st.lf_count + ((size > 0 && data[size - 1] != '\n') ? 1 : 0);
+    result.first_lf = st.found_lf ? st.first_lf : size;
+    result.first_is_crlf = st.first_is_crlf;
+    return result;
+}
+
+size_t
+findMismatch(const char* a, const char* b, size_t size)
+{
+    // Let memcmp skip over the equal blocks, then pin down the exact byte.
+    size_t block = 0;
+    while (block < size) {
+        const size_t n = std::min(mismatch_block_size, size - block);
+        if (memcmp(a + block, b + block, n) != 0)
+            break;
+        block += n;
+    }
+    if (block >= size)
+        return size;
+
+    const size_t end = std::min(block + mismatch_block_size, size);
+    size_t i = block;
+    if (const MismatchKernel kernel = selectKernel().mismatch)
+        i += kernel(a + block, b + block, end - block);
+    while (i < end && a[i] == b[i])
+        ++i;
+    return i;
+}
+
+size_t
+findLineMismatch(const char* a, const char* b, size_t size, bool fold_case)
+{
+    const KernelInfo& info = selectKernel();
+    size_t i = 0;
+    if (fold_case) {
+        if (info.mismatch_folded != nullptr)
+            i = info.mismatch_folded(a, b, size);
+        while (i < size && foldCase(a[i]) == foldCase(b[i]))
+            ++i;
+    } else {
+        if (info.mismatch != nullptr)
+            i = info.mismatch(a, b, size);
+        while (i < size && a[i] == b[i])
+            ++i;
+    }
+    return i;
+}
+
+size_t
+countMismatches(const char* a, const char* b, size_t size)
+{
+    size_t count = 0;
+    size_t i = 0;
+    if (const CountKernel kernel = selectKernel().count_mismatches)
+        count = kernel(a, b, size, i);
+    for (; i < size; ++i)
+        count += (a[i] != b[i]) ? 1 : 0;
+    return count;
+}
+
+const char*
+getScanKernel()
+{
+    return selectKernel().name;
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,63 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "LineCheckpoints.h"
+
+// System includes.
+#include <cstddef>
+#include <cstdint>
+
+namespace AbeCmp {
+
+// The result of a single sweep over a buffer looking for line endings.
+struct ScanResult
+{
+    // Number of LF characters found.
+    int64_t lf_count = 0;
+    // Number of LF characters that are part of a CRLF pair.
+    int64_t crlf_count = 0;
+    // Number of lines, counting a last line without a line ending.
+    int64_t line_count = 0;
+    // Offset of the first LF in the buffer, or size when there is none.
+    size_t first_lf = 0;
+    // True if the first LF is part of a CRLF pair.
+    bool first_is_crlf = false;
+};
+
+// Count lines and classify the first line ending in one sweep over the data.
+// Uses AVX2 or SSE2 when the host supports it and a scalar loop otherwise.
+// With checkpoints, the start of every checkpoint line is added to it in the
+// same sweep; data then starts at byte base of the file, after lines_before lines.
+ScanResult scanLines(const char* data, size_t size, LineCheckpoints* checkpoints = nullptr, uint64_t base = 0, int64_t lines_before = 0);
+// Find the offset of the first byte that differs between a and b.
+// Returns size when the buffers are equal.
+size_t findMismatch(const char* a, const char* b, size_t size);
+// Find the offset of the first byte that differs between two lines, with
+// ASCII letters of either case equal when fold_case is set. Unlike
+// findMismatch(), this goes straight to the vector kernel, which suits
+// line-sized buffers. Returns size when the buffers are equal.
+size_t findLineMismatch(const char* a, const char* b, size_t size, bool fold_case);
+// Count the bytes that differ between a and b, at memory bandwidth on hosts
+// with AVX2 or SSE2.
+size_t countMismatches(const char* a, const char* b, size_t size);
+// The name of the scan kernel that was selected for this host.
+const char* getScanKernel();
+
+} // namespace AbeCmp
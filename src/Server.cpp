@@ -0,0 +1,485 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Project includes.
+#include "Server.h"
+
+// System includes.
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+
+#if !defined(_WIN32)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace AbeCmp {
+
+namespace {
+
+// The size of the frame header that holds the payload size.
+const size_t frame_header_size = 4;
+// Larger frames are refused, so a bad peer can't make the other side allocate
+// without bound.
+const uint32_t max_frame_size = 64u << 20;
+// How often run() checks whether to keep running, in milliseconds.
+const int accept_poll_ms = 200;
+
+#if !defined(_WIN32)
+
+// @brief Write all bytes to a socket. A peer that went away is an error, not
+//        a SIGPIPE.
+bool
+writeAll(int fd, const char* data, size_t size)
+{
+#if defined(MSG_NOSIGNAL)
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    while (size > 0) {
+        const ssize_t n = send(fd, data, size, flags);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// @brief Read exactly size bytes from a socket.
+bool
+readAll(int fd, char* data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t n = recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// @brief Start a frame in buffer, leaving room for its header.
+void
+beginFrame(std::string& frame)
+{
+    frame.assign(frame_header_size, '\0');
+}
+
+// @brief Fill in the header of a frame and send it.
+bool
+sendFrame(int fd, std::string& frame)
+{
+    const uint32_t size = static_cast<uint32_t>(frame.size() - frame_header_size);
+    for (size_t i = 0; i < frame_header_size; ++i)
+        frame[i] = static_cast<char>((size >> (8 * i)) & 0xff);
+    return writeAll(fd, frame.data(), frame.size());
+}
+
+// @brief Receive the payload of a frame.
+bool
+receiveFrame(int fd, std::string& payload)
+{
+    unsigned char header[frame_header_size];
+    if (!readAll(fd, reinterpret_cast<char*>(header), sizeof(header)))
+        return false;
+    uint32_t size = 0;
+    for (size_t i = 0; i < frame_header_size; ++i)
+        size |= static_cast<uint32_t>(header[i]) << (8 * i);
+    if (size > max_frame_size)
+        return false;
+    payload.resize(size);
+    return readAll(fd, payload.data(), size);
+}
+
+// @brief Fill in the address of a socket path. Returns false if it is too long.
+bool
+makeAddress(const std::string& path, sockaddr_un& address)
+{
+    address = {};
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+        return false;
+    memcpy(address.sun_path, path.data(), path.size());
+    return true;
+}
+
+// @brief Open a stream socket that doesn't raise SIGPIPE where MSG_NOSIGNAL is missing.
+int
+openSocket()
+{
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+#if defined(SO_NOSIGPIPE)
+    if (fd >= 0) {
+        const int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+    }
+#endif
+    return fd;
+}
+
+#endif
+
+// @brief The name of a pair status in the protocol.
+const char*
+getStatusName(PairStatus status)
+{
+    switch (status) {
+        case PairStatus::MATCH:
+            return "match";
+        case PairStatus::DIFFER:
+            return "differ";
+        case PairStatus::ERROR:
+            break;
+    }
+    return "error";
+}
+
+// @brief Split the next tab separated field off text.
+std::string_view
+nextField(std::string_view& text)
+{
+    const size_t tab = text.find('\t');
+    const std::string_view field = text.substr(0, tab);
+    text = (tab == std::string_view::npos) ? std::string_view() : text.substr(tab + 1);
+    return field;
+}
+
+} // namespace
+
+CompareServer::CompareServer(const TreeOptions& options)
+  : m_options(options)
+  , m_pool(options.jobs)
+{
+}
+
+CompareServer::~CompareServer()
+{
+    reapConnections(true);
+#if !defined(_WIN32)
+    if (m_listen_fd >= 0) {
+        ::close(m_listen_fd);
+        unlink(m_path.c_str());
+    }
+#endif
+}
+
+bool
+CompareServer::listen(const std::string& path)
+{
+#if defined(_WIN32)
+    (void)path;
+    return false;
+#else
+    sockaddr_un address;
+    if (!makeAddress(path, address))
+        return false;
+    struct stat st = {};
+    if (lstat(path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode))
+            return false;
+        // A server still answering on it keeps its socket.
+        const int probe = openSocket();
+        const bool live = probe >= 0 && ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0)
+            ::close(probe);
+        if (live)
+            return false;
+        unlink(path.c_str());
+    }
+
+    m_listen_fd = openSocket();
+    if (m_listen_fd < 0)
+        return false;
+    if (bind(m_listen_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(m_listen_fd, SOMAXCONN) != 0) {
+        ::close(m_listen_fd);
+        m_listen_fd = -1;
+        return false;
+    }
+    m_path = path;
+    return true;
+#endif
+}
+
+// @brief Accept connections and give each a thread. The wait for a connection
+//        times out now and then, and a signal ends it early, to check
+//        keep_running.
+void
+CompareServer::run(const std::function<bool()>& keep_running)
+{
+#if defined(_WIN32)
+    (void)keep_running;
+#else
+    while (keep_running()) {
+        pollfd poll_fd = { m_listen_fd, POLLIN, 0 };
+        const int ready = poll(&poll_fd, 1, accept_poll_ms);
+        reapConnections(false);
+        if (ready <= 0)
+            continue;
+        const int fd = accept(m_listen_fd, nullptr, nullptr);
+        if (fd < 0)
+            continue;
+        m_connections.push_back(std::make_unique<Connection>());
+        Connection& connection = *m_connections.back();
+        connection.fd = fd;
+        connection.thread = std::thread([this, &connection] {
+            serve(connection);
+            connection.done = true;
+        });
+    }
+    reapConnections(true);
+    ::close(m_listen_fd);
+    m_listen_fd = -1;
+    unlink(m_path.c_str());
+#endif
+}
+
+// @brief With all, the connections that are still open are shut down first,
+//        which ends their reads.
+void
+CompareServer::reapConnections(bool all)
+{
+#if !defined(_WIN32)
+    for (auto it = m_connections.begin(); it != m_connections.end();) {
+        Connection& connection = **it;
+        if (!all && !connection.done) {
+            ++it;
+            continue;
+        }
+        if (!connection.done)
+            shutdown(connection.fd, SHUT_RDWR);
+        connection.thread.join();
+        ::close(connection.fd);
+        it = m_connections.erase(it);
+    }
+#else
+    (void)all;
+#endif
+}
+
+void
+CompareServer::serve(Connection& connection)
+{
+#if !defined(_WIN32)
+    // Replies are sent from the pool threads, one frame at a time.
+    std::mutex write_mutex;
+    std::string request;
+    while (receiveFrame(connection.fd, request)) {
+        if (!runBatch(connection.fd, write_mutex, request))
+            break;
+    }
+#else
+    (void)connection;
+#endif
+}
+
+// @brief Queue every pair of the batch on the pool. Each pool thread sends
+//        the reply of its pair as soon as it is done, from a frame buffer of
+//        its own that it reuses. The "done" frame follows the last reply.
+bool
+CompareServer::runBatch(int fd, std::mutex& write_mutex, const std::string& request)
+{
+#if defined(_WIN32)
+    (void)fd;
+    (void)write_mutex;
+    (void)request;
+    return false;
+#else
+    struct BatchState
+    {
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t pending = 0;
+        BatchReply totals;
+        bool failed = false;
+    } state;
+
+    // A reply is sent under the write lock, so frames never interleave.
+    auto reply = [&](long id, const PairResult& result) {
+        thread_local std::string frame;
+        beginFrame(frame);
+        frame += "result\t";
+        frame += std::to_string(id);
+        frame += '\t';
+        frame += getStatusName(result.status);
+        frame += '\t';
+        frame += result.detail;
+        frame += '\n';
+        frame += result.records;
+        bool sent = false;
+        {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            sent = sendFrame(fd, frame);
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        ++state.totals.pairs;
+        state.totals.matched += (result.status == PairStatus::MATCH) ? 1 : 0;
+        state.totals.differed += (result.status == PairStatus::DIFFER) ? 1 : 0;
+        state.totals.errors += (result.status == PairStatus::ERROR) ? 1 : 0;
+        state.failed |= !sent;
+        if (--state.pending == 0)
+            state.finished.notify_one();
+    };
+
+    std::string_view text = request;
+    long id = 0;
+    while (!text.empty()) {
+        const size_t lf = text.find('\n');
+        std::string_view line = text.substr(0, lf);
+        text = (lf == std::string_view::npos) ? std::string_view() : text.substr(lf + 1);
+        if (line.empty())
+            continue;
+        std::string path_a(nextField(line));
+        std::string path_b(line);
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            ++state.pending;
+        }
+        m_pool.submit([this, &reply, id, path_a = std::move(path_a), path_b = std::move(path_b)] {
+            PairResult result;
+            if (path_b.empty()) {
+                result.status = PairStatus::ERROR;
+                result.detail = "not a pair of paths";
+            } else {
+                compareFiles(path_a, path_b, m_options, result);
+            }
+            reply(id, result);
+        });
+        ++id;
+    }
+
+    std::unique_lock<std::mutex> lock(state.mutex);
+    state.finished.wait(lock, [&] { return state.pending == 0; });
+    ++m_batches;
+    m_pairs += state.totals.pairs;
+    if (state.failed)
+        return false;
+
+    std::string frame;
+    beginFrame(frame);
+    frame += "done\t" + std::to_string(state.totals.pairs) + '\t' + std::to_string(state.totals.matched) + '\t' + std::to_string(state.totals.differed) +
+             '\t' + std::to_string(state.totals.errors) + '\n';
+    std::lock_guard<std::mutex> write_lock(write_mutex);
+    return sendFrame(fd, frame);
+#endif
+}
+
+CompareClient::~CompareClient()
+{
+    close();
+}
+
+bool
+CompareClient::connect(const std::string& path)
+{
+#if defined(_WIN32)
+    (void)path;
+    return false;
+#else
+    close();
+    sockaddr_un address;
+    if (!makeAddress(path, address))
+        return false;
+    m_fd = openSocket();
+    if (m_fd < 0)
+        return false;
+    if (::connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+#endif
+}
+
+void
+CompareClient::close()
+{
+#if !defined(_WIN32)
+    if (m_fd >= 0)
+        ::close(m_fd);
+#endif
+    m_fd = -1;
+}
+
+// @brief Send the batch, then read replies until the "done" frame.
+bool
+CompareClient::compareBatch(const std::vector<FilePair>& pairs, const ReplyHandler& handler, BatchReply& totals)
+{
+#if defined(_WIN32)
+    (void)pairs;
+    (void)handler;
+    (void)totals;
+    return false;
+#else
+    if (m_fd < 0)
+        return false;
+    beginFrame(m_frame);
+    for (const FilePair& pair : pairs) {
+        for (const std::string* path : { &pair.first, &pair.second }) {
+            if (path->find_first_of("\t\n") != std::string::npos)
+                return false;
+            std::error_code error;
+            const std::filesystem::path absolute = std::filesystem::absolute(*path, error);
+            m_frame += error ? *path : absolute.string();
+            m_frame += (path == &pair.first) ? '\t' : '\n';
+        }
+    }
+    if (!sendFrame(m_fd, m_frame))
+        return false;
+
+    PairReply reply;
+    while (receiveFrame(m_fd, m_frame)) {
+        const size_t lf = m_frame.find('\n');
+        std::string_view header = std::string_view(m_frame).substr(0, lf);
+        const std::string_view type = nextField(header);
+        if (type == "done") {
+            totals = BatchReply();
+            totals.pairs = std::atol(std::string(nextField(header)).c_str());
+            totals.matched = std::atol(std::string(nextField(header)).c_str());
+            totals.differed = std::atol(std::string(nextField(header)).c_str());
+            totals.errors = std::atol(std::string(nextField(header)).c_str());
+            return true;
+        }
+        if (type != "result" || lf == std::string::npos)
+            return false;
+        reply.id = std::atol(std::string(nextField(header)).c_str());
+        const std::string_view status = nextField(header);
+        reply.result.status = (status == "match") ? PairStatus::MATCH : (status == "differ") ? PairStatus::DIFFER : PairStatus::ERROR;
+        reply.result.detail.assign(header);
+        reply.result.records.assign(m_frame, lf + 1);
+        handler(reply);
+    }
+    return false;
+#endif
+}
+
+} // namespace AbeCmp
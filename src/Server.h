@@ -0,0 +1,148 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "ThreadPool.h"
+#include "TreeCompare.h"
+
+// System includes.
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace AbeCmp {
+
+// The protocol between CompareClient and CompareServer, over a Unix domain
+// stream socket. Every message is a frame: the payload size as 4 bytes, little
+// endian, then the payload, which is text.
+// - A client sends a batch as one frame with one pair per line: the absolute
+//   path of file a, a tab, and the absolute path of file b.
+// - The server answers each pair with a frame as soon as the pair is done, so
+//   replies come in the order the pairs finish, not the order they were sent:
+//   "result", the zero based index of the pair in the batch, and "match",
+//   "differ" or "error", separated by tabs, then a tab, the detail and a LF,
+//   then the "@@" records, if any.
+// - After the last pair, the server sends "done" and the counts of pairs,
+//   matches, differences and errors, separated by tabs, with a LF.
+// A client sends its next batch after the "done" frame of the last one. The
+// comparison options are the server's, set when it was started.
+
+// The reply to one pair of a batch.
+struct PairReply
+{
+    // The index of the pair in its batch.
+    long id = 0;
+    PairResult result;
+};
+
+// The counts the server sends after the last pair of a batch.
+struct BatchReply
+{
+    long pairs = 0;
+    long matched = 0;
+    long differed = 0;
+    long errors = 0;
+};
+
+using FilePair = std::pair<std::string, std::string>;
+
+// A resident comparison server. Connections are served on threads of their
+// own, and the pairs of every batch are compared on one shared thread pool, so
+// there is no process startup or argument parsing per comparison, and the
+// scan cache in the options stays warm between batches.
+class CompareServer
+{
+  public:
+    // The pool has options.jobs threads. Pairs are compared with the options,
+    // including their scan cache.
+    explicit CompareServer(const TreeOptions& options);
+    ~CompareServer();
+    CompareServer(const CompareServer&) = delete;
+    CompareServer& operator=(const CompareServer&) = delete;
+
+    // Listen on a Unix domain socket at path. A socket left behind by a server
+    // that is gone is replaced; a live server's socket or any other file is not.
+    bool listen(const std::string& path);
+    // Serve connections until keep_running returns false, which is checked a
+    // few times a second. Then close every connection and remove the socket.
+    void run(const std::function<bool()>& keep_running);
+
+    long getBatchCount() const { return m_batches; }
+    long getPairCount() const { return m_pairs; }
+
+  private:
+    // A client connection and the thread that serves it.
+    struct Connection
+    {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> done{ false };
+    };
+
+    // Read batches from a connection and answer them, until it closes.
+    void serve(Connection& connection);
+    // Compare the pairs of a batch on the pool and send the replies. Returns
+    // false if the connection failed.
+    bool runBatch(int fd, std::mutex& write_mutex, const std::string& request);
+    // Join the threads of connections that closed.
+    void reapConnections(bool all);
+
+  private:
+    TreeOptions m_options;
+    ThreadPool m_pool;
+    std::string m_path;
+    int m_listen_fd = -1;
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    std::atomic<long> m_batches{ 0 };
+    std::atomic<long> m_pairs{ 0 };
+};
+
+// A client of CompareServer.
+class CompareClient
+{
+  public:
+    CompareClient() = default;
+    ~CompareClient();
+    CompareClient(const CompareClient&) = delete;
+    CompareClient& operator=(const CompareClient&) = delete;
+
+    // Connect to the server listening at path.
+    bool connect(const std::string& path);
+    void close();
+
+    // Receives each reply of a batch as it arrives.
+    using ReplyHandler = std::function<void(const PairReply& reply)>;
+    // Send the pairs as one batch and hand each reply to the handler, in the
+    // order the pairs finish. Relative paths are made absolute, since the
+    // server runs in a directory of its own. Returns false if a path has a tab
+    // or a LF in it, or the connection failed.
+    bool compareBatch(const std::vector<FilePair>& pairs, const ReplyHandler& handler, BatchReply& totals);
+
+  private:
+    int m_fd = -1;
+    // Reused for every frame sent and received.
+    std::string m_frame;
+};
+
+} // namespace AbeCmp
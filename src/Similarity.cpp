@@ -0,0 +1,171 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+// Project includes.
+#include "Similarity.h"
+#include "Hash.h"
+#include "Stats.h"
+
+// System includes.
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace AbeCmp {
+
+namespace {
+
+// Regions start at this many lines, and are merged in pairs once there are
+// max_regions of them.
+const int64_t first_region_lines = 256;
+const size_t max_regions = 32;
+
+// The signatures of one input as it is read.
+struct InputSketch
+{
+    MinHashSketch whole;
+    std::vector<MinHashSketch> regions;
+    int64_t region_lines = first_region_lines;
+    int64_t lines = 0;
+};
+
+// @brief Merge the regions in pairs, which doubles the lines per region.
+void
+halveRegions(InputSketch& sketch)
+{
+    const size_t count = sketch.regions.size();
+    for (size_t i = 0; i < count; i += 2) {
+        sketch.regions[i / 2] = sketch.regions[i];
+        if (i + 1 < count)
+            sketch.regions[i / 2].merge(sketch.regions[i + 1]);
+    }
+    sketch.regions.resize((count + 1) / 2);
+    sketch.region_lines *= 2;
+}
+
+// @brief Read an input to the end and build its signatures. A shingle is added
+//        to the region of its last line.
+void
+sketchInput(StreamReader& stream, const SimilarityOptions& options, InputSketch& sketch)
+{
+    ScopedPhase phase(StatPhase::COMPARE);
+    const size_t width = static_cast<size_t>(std::max(1L, options.shingle_lines));
+    std::vector<uint64_t> window(width, 0);
+    std::string scratch;
+    std::string_view line;
+    while (stream.nextLine(line)) {
+        const uint64_t line_hash = options.normalization.any() ? hashNormalized(line, options.normalization, scratch)
+                                                               : hashBytes(line.data(), line.size());
+        const int64_t number = sketch.lines++;
+        if (width > 1)
+            std::memmove(window.data(), window.data() + 1, (width - 1) * sizeof(uint64_t));
+        window[width - 1] = line_hash;
+        if (number + 1 < static_cast<int64_t>(width))
+            continue;
+
+        // A line hash is already spread evenly over the buckets.
+        const uint64_t shingle = width == 1 ? line_hash : hashBytes(reinterpret_cast<const char*>(window.data()), width * sizeof(uint64_t), width);
+        size_t region = static_cast<size_t>(number / sketch.region_lines);
+        while (region >= max_regions) {
+            halveRegions(sketch);
+            region = static_cast<size_t>(number / sketch.region_lines);
+        }
+        while (region >= sketch.regions.size())
+            sketch.regions.emplace_back();
+        sketch.whole.add(shingle);
+        sketch.regions[region].add(shingle);
+    }
+    phase.addLines(static_cast<uint64_t>(sketch.lines));
+}
+
+} // namespace
+
+MinHashSketch::MinHashSketch()
+{
+    m_mins.fill(std::numeric_limits<uint64_t>::max());
+}
+
+void
+MinHashSketch::merge(const MinHashSketch& other)
+{
+    for (size_t i = 0; i < buckets; ++i)
+        m_mins[i] = std::min(m_mins[i], other.m_mins[i]);
+}
+
+// @brief Estimate the Jaccard similarity as the share of the buckets used by
+//        either set that hold the same minimum in both.
+double
+MinHashSketch::similarity(const MinHashSketch& a, const MinHashSketch& b)
+{
+    const uint64_t empty = std::numeric_limits<uint64_t>::max();
+    size_t used = 0;
+    size_t same = 0;
+    for (size_t i = 0; i < buckets; ++i) {
+        if (a.m_mins[i] == empty && b.m_mins[i] == empty)
+            continue;
+        ++used;
+        if (a.m_mins[i] == b.m_mins[i])
+            ++same;
+    }
+    return used == 0 ? 1.0 : static_cast<double>(same) / static_cast<double>(used);
+}
+
+// @brief Sketch both inputs at the same time, then compare the whole signatures
+//        and the regions at the same position.
+bool
+compareSimilarity(StreamReader& stream_a, StreamReader& stream_b, const SimilarityOptions& options, SimilarityResult& result)
+{
+    InputSketch sketch_a, sketch_b;
+    std::thread thread_b([&] { sketchInput(stream_b, options, sketch_b); });
+    sketchInput(stream_a, options, sketch_a);
+    thread_b.join();
+    if (stream_a.hasError() || stream_b.hasError())
+        return false;
+
+    // Both inputs need regions of the same size to line them up.
+    while (sketch_a.region_lines < sketch_b.region_lines)
+        halveRegions(sketch_a);
+    while (sketch_b.region_lines < sketch_a.region_lines)
+        halveRegions(sketch_b);
+
+    result.similarity = MinHashSketch::similarity(sketch_a.whole, sketch_b.whole);
+    result.lines_a = sketch_a.lines;
+    result.lines_b = sketch_b.lines;
+    result.region_lines = sketch_a.region_lines;
+    result.regions.clear();
+
+    // A region that only one input reaches shares nothing with the other.
+    const MinHashSketch none;
+    const size_t count = std::max(sketch_a.regions.size(), sketch_b.regions.size());
+    for (size_t i = 0; i < count; ++i) {
+        SimilarityRegion region;
+        const int64_t first = static_cast<int64_t>(i) * result.region_lines;
+        region.a_first = std::min(first, result.lines_a);
+        region.a_count = std::clamp<int64_t>(result.lines_a - first, 0, result.region_lines);
+        region.b_first = std::min(first, result.lines_b);
+        region.b_count = std::clamp<int64_t>(result.lines_b - first, 0, result.region_lines);
+        region.similarity = MinHashSketch::similarity(i < sketch_a.regions.size() ? sketch_a.regions[i] : none,
+                                                      i < sketch_b.regions.size() ? sketch_b.regions[i] : none);
+        result.regions.push_back(region);
+    }
+    return true;
+}
+
+} // namespace AbeCmp
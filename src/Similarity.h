@@ -0,0 +1,96 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "Normalize.h"
+#include "StreamReader.h"
+
+// System includes.
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace AbeCmp {
+
+// A one permutation MinHash signature of a set of hashes: the smallest hash
+// that falls in each of a fixed number of buckets. Two signatures estimate the
+// Jaccard similarity of their sets in constant memory, however big the sets are.
+class MinHashSketch
+{
+  public:
+    // The number of buckets. The estimate is within about 1 / sqrt(buckets).
+    static constexpr size_t buckets = 512;
+
+    MinHashSketch();
+    // Add a well mixed hash to the set.
+    void add(uint64_t hash)
+    {
+        uint64_t& min = m_mins[hash >> bucket_shift];
+        if (hash < min)
+            min = hash;
+    }
+    // Make this the signature of the union of both sets.
+    void merge(const MinHashSketch& other);
+    // Estimate the Jaccard similarity of the sets of both signatures, from 0 to 1.
+    // Two empty sets are the same.
+    static double similarity(const MinHashSketch& a, const MinHashSketch& b);
+
+  private:
+    // The top bits of a hash pick its bucket.
+    static constexpr int bucket_shift = 64 - 9;
+    std::array<uint64_t, buckets> m_mins;
+};
+
+struct SimilarityOptions
+{
+    // The number of consecutive lines hashed together as one set element.
+    long shingle_lines = 1;
+    Normalization normalization;
+};
+
+// The similarity of the lines at the same position in both files.
+struct SimilarityRegion
+{
+    // Zero based first lines and line counts of the region in each file.
+    int64_t a_first = 0;
+    int64_t a_count = 0;
+    int64_t b_first = 0;
+    int64_t b_count = 0;
+    double similarity = 0.0;
+};
+
+struct SimilarityResult
+{
+    // The estimated Jaccard similarity of the line shingles of both files.
+    double similarity = 0.0;
+    int64_t lines_a = 0;
+    int64_t lines_b = 0;
+    // The files split into regions of this many lines, compared region by region.
+    int64_t region_lines = 0;
+    std::vector<SimilarityRegion> regions;
+};
+
+// Estimate how similar two inputs are, reading each once (on its own thread)
+// and keeping only MinHash signatures: one for the whole input and one per
+// region. Regions start small and are merged in pairs as the input grows, so
+// there are never more than a few dozen of them. Line endings don't count.
+// Returns false if reading an input failed.
+bool compareSimilarity(StreamReader& stream_a, StreamReader& stream_b, const SimilarityOptions& options, SimilarityResult& result);
+
+} // namespace AbeCmp
@@ -0,0 +1,120 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "Stats.h"
+
+// System includes.
+#include <cstdio>
+
+namespace AbeCmp {
+
+namespace {
+
+const char* const phase_names[] = { "load", "scan", "first difference", "compare", "diff", "write" };
+
+} // namespace
+
+bool Stats::s_enabled = false;
+std::atomic<uint64_t> Stats::s_counters[static_cast<int>(StatCounter::COUNT)] = {};
+Stats::PhaseTotals Stats::s_phases[static_cast<int>(StatPhase::COUNT)];
+
+void
+Stats::addPhase(StatPhase phase, uint64_t nanoseconds, uint64_t bytes, uint64_t lines)
+{
+    PhaseTotals& totals = s_phases[static_cast<int>(phase)];
+    totals.calls.fetch_add(1, std::memory_order_relaxed);
+    totals.nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+    totals.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    totals.lines.fetch_add(lines, std::memory_order_relaxed);
+}
+
+const char*
+Stats::getPhaseName(StatPhase phase)
+{
+    return phase_names[static_cast<int>(phase)];
+}
+
+// @brief Format the report as a table with one row per phase that ran,
+//        followed by the counters.
+std::string
+Stats::formatText()
+{
+    char row[256];
+    std::string text = "\nStats:\n";
+    snprintf(row, sizeof(row), "%-18s %12s %8s %14s %12s %10s\n", "phase", "time", "calls", "bytes", "lines", "MB/s");
+    text += row;
+    for (int p = 0; p < static_cast<int>(StatPhase::COUNT); ++p) {
+        const PhaseTotals& totals = s_phases[p];
+        const uint64_t calls = totals.calls.load(std::memory_order_relaxed);
+        if (calls == 0)
+            continue;
+        const double ms = totals.nanoseconds.load(std::memory_order_relaxed) / 1e6;
+        const uint64_t bytes = totals.bytes.load(std::memory_order_relaxed);
+        const uint64_t lines = totals.lines.load(std::memory_order_relaxed);
+        // Phases that don't know their bytes or lines show a dash.
+        const std::string bytes_text = bytes > 0 ? std::to_string(bytes) : "-";
+        const std::string lines_text = lines > 0 ? std::to_string(lines) : "-";
+        char rate[32] = "-";
+        if (bytes > 0 && ms > 0)
+            snprintf(rate, sizeof(rate), "%.1f", bytes / (ms * 1e3));
+        snprintf(row, sizeof(row), "%-18s %9.1f ms %8llu %14s %12s %10s\n", phase_names[p], ms, static_cast<unsigned long long>(calls),
+                 bytes_text.c_str(), lines_text.c_str(), rate);
+        text += row;
+    }
+    snprintf(row, sizeof(row), "read() calls: %llu (%llu bytes), mmap() calls: %llu (%llu bytes)\n",
+             static_cast<unsigned long long>(get(StatCounter::READ_CALLS)), static_cast<unsigned long long>(get(StatCounter::READ_BYTES)),
+             static_cast<unsigned long long>(get(StatCounter::MAP_CALLS)), static_cast<unsigned long long>(get(StatCounter::MAP_BYTES)));
+    text += row;
+    snprintf(row, sizeof(row), "write calls: %llu (%llu bytes), scan cache: %llu hits, %llu misses\n",
+             static_cast<unsigned long long>(get(StatCounter::WRITE_CALLS)), static_cast<unsigned long long>(get(StatCounter::WRITE_BYTES)),
+             static_cast<unsigned long long>(get(StatCounter::CACHE_HITS)), static_cast<unsigned long long>(get(StatCounter::CACHE_MISSES)));
+    text += row;
+    snprintf(row, sizeof(row), "allocations: %llu (%llu bytes)\n", static_cast<unsigned long long>(get(StatCounter::ALLOCATIONS)),
+             static_cast<unsigned long long>(get(StatCounter::ALLOCATED_BYTES)));
+    text += row;
+    return text;
+}
+
+// @brief Format the report as one JSON object, for the JSON lines output.
+std::string
+Stats::formatJson()
+{
+    static const char* const counter_names[] = { "read_calls",  "read_bytes", "map_calls",   "map_bytes",   "write_calls",
+                                                 "write_bytes", "cache_hits", "cache_misses", "allocations", "allocated_bytes" };
+    std::string json = "{\"type\":\"stats\",\"phases\":{";
+    bool first = true;
+    for (int p = 0; p < static_cast<int>(StatPhase::COUNT); ++p) {
+        const PhaseTotals& totals = s_phases[p];
+        const uint64_t calls = totals.calls.load(std::memory_order_relaxed);
+        if (calls == 0)
+            continue;
+        if (!first)
+            json += ',';
+        first = false;
+        json += "\"" + std::string(phase_names[p]) + "\":{\"calls\":" + std::to_string(calls);
+        json += ",\"ns\":" + std::to_string(totals.nanoseconds.load(std::memory_order_relaxed));
+        json += ",\"bytes\":" + std::to_string(totals.bytes.load(std::memory_order_relaxed));
+        json += ",\"lines\":" + std::to_string(totals.lines.load(std::memory_order_relaxed)) + "}";
+    }
+    json += "}";
+    for (int c = 0; c < static_cast<int>(StatCounter::COUNT); ++c)
+        json += ",\"" + std::string(counter_names[c]) + "\":" + std::to_string(get(static_cast<StatCounter>(c)));
+    json += "}\n";
+    return json;
+}
+
+} // namespace AbeCmp
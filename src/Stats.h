@@ -0,0 +1,140 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// System includes.
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace AbeCmp {
+
+// The timed phases of a run. Phases that run on worker threads (tree
+// comparisons, parallel chunks) add up the time of every thread. Writing out
+// differences happens while comparing, so write time is part of compare time too.
+enum class StatPhase
+{
+    // Mapping, reading or decompressing the files. The pages of a mapped file are read in
+    // when they are first touched, which shows up in the scan phase.
+    LOAD,
+    // Counting lines, picking the line ending, hashing lines and digests.
+    SCAN,
+    // The block compare that skips the equal prefix.
+    FIRST_DIFFERENCE,
+    // The line by line comparison.
+    COMPARE,
+    // Matching up lines with a diff algorithm.
+    DIFF,
+    // Writing formatted differences out.
+    WRITE,
+    COUNT
+};
+
+// The counted events of a run.
+enum class StatCounter
+{
+    READ_CALLS,
+    READ_BYTES,
+    MAP_CALLS,
+    MAP_BYTES,
+    WRITE_CALLS,
+    WRITE_BYTES,
+    CACHE_HITS,
+    CACHE_MISSES,
+    ALLOCATIONS,
+    ALLOCATED_BYTES,
+    COUNT
+};
+
+// Process wide counters for --stats. Everything is a relaxed atomic add behind
+// a single flag, so the instrumentation costs a branch when it is off.
+class Stats
+{
+  public:
+    static void enable(bool on) { s_enabled = on; }
+    static bool enabled() { return s_enabled; }
+
+    static void add(StatCounter counter, uint64_t value = 1)
+    {
+        if (s_enabled)
+            s_counters[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+    static void addPhase(StatPhase phase, uint64_t nanoseconds, uint64_t bytes, uint64_t lines);
+    // Count an allocation. Called from operator new, so it must not allocate.
+    static void countAllocation(size_t size)
+    {
+        add(StatCounter::ALLOCATIONS);
+        add(StatCounter::ALLOCATED_BYTES, size);
+    }
+
+    static uint64_t get(StatCounter counter) { return s_counters[static_cast<int>(counter)].load(std::memory_order_relaxed); }
+    static const char* getPhaseName(StatPhase phase);
+
+    // The report as a table, or as a single JSON object of type "stats".
+    static std::string formatText();
+    static std::string formatJson();
+
+  private:
+    struct PhaseTotals
+    {
+        std::atomic<uint64_t> calls{ 0 };
+        std::atomic<uint64_t> nanoseconds{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+        std::atomic<uint64_t> lines{ 0 };
+    };
+
+    static bool s_enabled;
+    static std::atomic<uint64_t> s_counters[static_cast<int>(StatCounter::COUNT)];
+    static PhaseTotals s_phases[static_cast<int>(StatPhase::COUNT)];
+};
+
+// Times a phase from construction to destruction, when stats are on.
+class ScopedPhase
+{
+  public:
+    explicit ScopedPhase(StatPhase phase)
+      : m_phase(phase)
+      , m_on(Stats::enabled())
+    {
+        if (m_on)
+            m_start = std::chrono::steady_clock::now();
+    }
+    ~ScopedPhase()
+    {
+        if (m_on) {
+            const auto elapsed = std::chrono::steady_clock::now() - m_start;
+            Stats::addPhase(m_phase, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), m_bytes, m_lines);
+        }
+    }
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    void addBytes(uint64_t bytes) { m_bytes += bytes; }
+    void addLines(uint64_t lines) { m_lines += lines; }
+
+  private:
+    StatPhase m_phase;
+    bool m_on;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_bytes = 0;
+    uint64_t m_lines = 0;
+};
+
+} // namespace AbeCmp
@@ -0,0 +1,430 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "StreamReader.h"
+#include "Stats.h"
+
+// System includes.
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace AbeCmp {
+
+// Read-ahead buffers: large enough that a pipe or network read is amortized,
+// few enough that two streams stay well under 64 MiB together.
+const static size_t stream_buffer_size = 4 << 20;
+const static size_t stream_buffer_count = 4;
+const static size_t stream_buffer_align = 4096;
+// Compressed input is read in blocks of this size and decompressed into the ring.
+const static size_t stream_input_size = 1 << 20;
+// Enough bytes to tell the compressed formats apart.
+const static size_t magic_size = 4;
+
+const static char* pretty_lf = "\\n";
+const static char* pretty_crlf = "\\r\\n";
+
+// @brief Read up to size bytes, retrying when interrupted.
+static long
+readSome(int fd, char* data, size_t size)
+{
+#if defined(_WIN32)
+    return _read(fd, data, static_cast<unsigned int>(size));
+#else
+    for (;;) {
+        ssize_t n = ::read(fd, data, size);
+        if (n >= 0 || errno != EINTR)
+            return static_cast<long>(n);
+    }
+#endif
+}
+
+StreamReader::~StreamReader()
+{
+    close();
+}
+
+// @brief True if name is stdin or anything other than a regular file.
+//        A name that can't be inspected is left to File, which reports the error.
+bool
+StreamReader::isStream(const std::string& name)
+{
+    if (name == "-")
+        return true;
+#if defined(_WIN32)
+    struct _stat st = {};
+    if (_stat(name.c_str(), &st) != 0)
+        return false;
+    return (st.st_mode & _S_IFREG) == 0;
+#else
+    struct stat st = {};
+    if (stat(name.c_str(), &st) != 0)
+        return false;
+    return !S_ISREG(st.st_mode);
+#endif
+}
+
+// @brief The read-ahead ring plus the input buffer of a compressed file.
+size_t
+StreamReader::getBufferMemory()
+{
+    return stream_buffer_count * stream_buffer_size + stream_input_size;
+}
+
+// @brief Open the input, start the read-ahead thread and detect the line ending.
+bool
+StreamReader::open(const std::string& name)
+{
+    close();
+    m_name = name;
+    if (name == "-") {
+        m_fd = 0;
+        m_own_fd = false;
+#if defined(_WIN32)
+        _setmode(0, _O_BINARY);
+#endif
+    } else {
+#if defined(_WIN32)
+        m_fd = _open(name.c_str(), _O_RDONLY | _O_BINARY);
+#else
+        m_fd = ::open(name.c_str(), O_RDONLY);
+#endif
+        if (m_fd < 0)
+            return false;
+        m_own_fd = true;
+    }
+
+    // A pipe may hand the first bytes over a few at a time.
+    m_input.resize(stream_input_size);
+    while (m_input_size < magic_size && !m_input_eof) {
+        long n = readSome(m_fd, m_input.data() + m_input_size, m_input.size() - m_input_size);
+        Stats::add(StatCounter::READ_CALLS);
+        if (n < 0)
+            return false;
+        m_input_eof = (n == 0);
+        m_input_size += static_cast<size_t>(n);
+    }
+    Stats::add(StatCounter::READ_BYTES, m_input_size);
+    m_compression = detectCompression(m_input.data(), m_input_size);
+    if (m_compression != Compression::NONE && !m_decompressor.init(m_compression))
+        return false;
+
+    m_ring.resize(stream_buffer_count);
+    for (auto& buffer : m_ring)
+        buffer.data = static_cast<char*>(::operator new(stream_buffer_size, std::align_val_t(stream_buffer_align)));
+
+    m_thread = std::thread([this] { readLoop(); });
+    return detectLineEnding() && !hasError();
+}
+
+// @brief Stop the read-ahead thread and close the input.
+void
+StreamReader::close()
+{
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_changed.notify_all();
+        m_thread.join();
+    }
+    if (m_own_fd && m_fd >= 0) {
+#if defined(_WIN32)
+        _close(m_fd);
+#else
+        ::close(m_fd);
+#endif
+    }
+    m_fd = -1;
+    m_own_fd = false;
+    for (auto& buffer : m_ring)
+        ::operator delete(buffer.data, std::align_val_t(stream_buffer_align));
+    m_ring.clear();
+    m_compression = Compression::NONE;
+    m_input.clear();
+    m_input.shrink_to_fit();
+    m_input_pos = 0;
+    m_input_size = 0;
+    m_input_eof = false;
+    m_decompressor.close();
+
+    m_filled = 0;
+    m_released = 0;
+    m_eof = false;
+    m_error = false;
+    m_stopping = false;
+    m_current = 0;
+    m_have_current = false;
+    m_pos = 0;
+    m_carry.clear();
+    m_carry_pending = false;
+    m_carry_returned = false;
+    m_line_count = 0;
+    m_lf_lines = 0;
+    m_crlf_lines = 0;
+    m_crlf = false;
+    m_line_crlf = false;
+}
+
+// @brief Fill the ring slots in order, waiting while all of them hold data the
+//        consumer hasn't released yet.
+void
+StreamReader::readLoop()
+{
+    for (uint64_t number = 0;; ++number) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_changed.wait(lock, [&] { return m_stopping || number - m_released < m_ring.size(); });
+            if (m_stopping)
+                return;
+        }
+
+        Buffer& buffer = m_ring[number % m_ring.size()];
+        ScopedPhase phase(StatPhase::LOAD);
+        bool eof = false;
+        bool error = false;
+        const size_t used = fillBuffer(buffer.data, eof, error);
+        buffer.size = used;
+        phase.addBytes(used);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (used > 0)
+                ++m_filled;
+            m_eof = eof;
+            m_error = error;
+        }
+        m_changed.notify_all();
+        if (eof)
+            return;
+    }
+}
+
+// @brief Fill a read-ahead buffer. Pipes hand out a few KiB per read, so keep
+//        reading until the buffer is full and the consumer sees few, large buffers.
+//        Compressed input is decompressed until the buffer is full.
+size_t
+StreamReader::fillBuffer(char* data, bool& eof, bool& error)
+{
+    size_t used = 0;
+    if (m_compression == Compression::NONE) {
+        // The bytes read to detect the compression come first.
+        used = std::min(m_input_size - m_input_pos, stream_buffer_size);
+        std::memcpy(data, m_input.data() + m_input_pos, used);
+        m_input_pos += used;
+        eof = m_input_eof && m_input_pos == m_input_size;
+        while (used < stream_buffer_size && !eof) {
+            long n = readSome(m_fd, data + used, stream_buffer_size - used);
+            Stats::add(StatCounter::READ_CALLS);
+            if (n <= 0) {
+                eof = true;
+                error = n < 0;
+                break;
+            }
+            used += static_cast<size_t>(n);
+            Stats::add(StatCounter::READ_BYTES, static_cast<uint64_t>(n));
+        }
+        return used;
+    }
+
+    while (used < stream_buffer_size) {
+        if (m_input_pos == m_input_size && !m_input_eof && !readInput()) {
+            eof = error = true;
+            break;
+        }
+        const char* in = m_input.data() + m_input_pos;
+        size_t in_size = m_input_size - m_input_pos;
+        size_t produced = 0;
+        if (!m_decompressor.decompress(in, in_size, data + used, stream_buffer_size - used, produced)) {
+            eof = error = true;
+            break;
+        }
+        const bool progress = produced > 0 || in_size < m_input_size - m_input_pos;
+        m_input_pos = m_input_size - in_size;
+        used += produced;
+        if (!progress && m_input_pos == m_input_size && m_input_eof) {
+            // A stream that stops in the middle was cut off.
+            eof = true;
+            error = !m_decompressor.isFinished();
+            break;
+        }
+        if (!progress && m_input_pos < m_input_size) {
+            eof = error = true;
+            break;
+        }
+    }
+    return used;
+}
+
+// @brief Read the next block of compressed input. Returns false if reading failed.
+bool
+StreamReader::readInput()
+{
+    long n = readSome(m_fd, m_input.data(), m_input.size());
+    Stats::add(StatCounter::READ_CALLS);
+    if (n < 0)
+        return false;
+    Stats::add(StatCounter::READ_BYTES, static_cast<uint64_t>(n));
+    m_input_pos = 0;
+    m_input_size = static_cast<size_t>(n);
+    m_input_eof = (n == 0);
+    return true;
+}
+
+// @brief Wait until count buffers in total were filled.
+//        Returns false if the input ended (or failed) before that.
+bool
+StreamReader::waitFilled(uint64_t count)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [&] { return m_filled >= count || m_eof; });
+    return m_filled >= count;
+}
+
+// @brief Give the buffer that is being consumed back to the read-ahead thread.
+void
+StreamReader::releaseCurrent()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_released;
+    }
+    m_changed.notify_all();
+    m_have_current = false;
+    ++m_current;
+}
+
+// @brief Find the first LF in the read-ahead buffers to pick the line ending,
+//        without consuming anything. A first line longer than the whole ring is
+//        taken to end in a plain LF. Fails if the input has no LF at all, like File.
+bool
+StreamReader::detectLineEnding()
+{
+    char last = '\0';
+    for (uint64_t number = 0; number < m_ring.size(); ++number) {
+        if (!waitFilled(number + 1))
+            return false;
+        const Buffer& buffer = m_ring[number];
+        const char* lf = static_cast<const char*>(std::memchr(buffer.data, '\n', buffer.size));
+        if (lf != nullptr) {
+            m_crlf = (lf == buffer.data ? last : lf[-1]) == '\r';
+            return true;
+        }
+        last = buffer.data[buffer.size - 1];
+    }
+    m_crlf = false;
+    return true;
+}
+
+// @brief Get the next line without its line ending.
+//        Lines are viewed in place in the read-ahead buffer; only a line that
+//        spans two buffers is copied, into m_carry.
+bool
+StreamReader::nextLine(std::string_view& line)
+{
+    if (m_carry_returned) {
+        m_carry.clear();
+        m_carry_returned = false;
+    }
+
+    for (;;) {
+        if (!m_have_current) {
+            if (!waitFilled(m_current + 1)) {
+                // The last line has no line ending.
+                if (!m_carry_pending)
+                    return false;
+                m_carry_pending = false;
+                m_carry_returned = true;
+                line = m_carry;
+                m_line_crlf = m_crlf;
+                m_line_unterminated = true;
+                ++m_line_count;
+                return true;
+            }
+            m_have_current = true;
+            m_pos = 0;
+        }
+
+        const Buffer& buffer = m_ring[m_current % m_ring.size()];
+        const char* begin = buffer.data + m_pos;
+        const size_t avail = buffer.size - m_pos;
+        const char* lf = static_cast<const char*>(std::memchr(begin, '\n', avail));
+        if (lf == nullptr) {
+            // The rest of the buffer starts a line that ends in a later buffer.
+            if (avail > 0) {
+                m_carry.append(begin, avail);
+                m_carry_pending = true;
+            }
+            releaseCurrent();
+            continue;
+        }
+
+        const size_t length = static_cast<size_t>(lf - begin);
+        m_pos += length + 1;
+        if (m_carry_pending) {
+            m_carry.append(begin, length);
+            m_carry_pending = false;
+            m_carry_returned = true;
+            line = m_carry;
+        } else {
+            line = std::string_view(begin, length);
+        }
+        m_line_crlf = !line.empty() && line.back() == '\r';
+        if (m_line_crlf) {
+            line.remove_suffix(1);
+            ++m_crlf_lines;
+        } else {
+            ++m_lf_lines;
+        }
+        ++m_line_count;
+        return true;
+    }
+}
+
+std::string
+StreamReader::getLineEnding() const
+{
+    return m_crlf ? "dos |crlf" : "unix|  lf";
+}
+
+// @brief The line ending of the last line as printed after it when line endings are shown.
+const char*
+StreamReader::getPrettyLE() const
+{
+    return m_line_crlf ? pretty_crlf : pretty_lf;
+}
+
+bool
+StreamReader::hasError() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_error;
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,152 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "Decompressor.h"
+
+// System includes.
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace AbeCmp {
+
+// Reads a file or stream front to back with a background read-ahead thread.
+// The thread fills a small ring of large aligned buffers while the caller works
+// through the lines of the previous buffers, so memory stays bounded no matter
+// how big the input is. Used for stdin ("-"), FIFOs and other inputs that can't
+// be memory mapped, compressed files, or when streaming is asked for.
+// gzip and zstd input is detected by its magic bytes and decompressed on the
+// read-ahead thread, from a small input buffer into the ring, so a compressed
+// file is compared in bounded memory and without a temporary file.
+class StreamReader
+{
+  public:
+    StreamReader() = default;
+    ~StreamReader();
+    StreamReader(const StreamReader&) = delete;
+    StreamReader& operator=(const StreamReader&) = delete;
+
+    // True if name is stdin or anything other than a regular file.
+    static bool isStream(const std::string& name);
+    // The most memory the read-ahead buffers of one reader take, in bytes.
+    static size_t getBufferMemory();
+
+    // Open the input, detect its compression and its line ending from the first LF.
+    bool open(const std::string& name);
+    // Stop the read-ahead thread and close the input.
+    void close();
+    // Get the next line without its line ending (LF or CRLF, whichever the line
+    // has). The view stays valid until the next call. Returns false at the end
+    // of the input.
+    bool nextLine(std::string_view& line);
+    // The number of lines returned so far.
+    int64_t getLineCount() const { return m_line_count; }
+    // The number of lines returned so far that end in a plain LF and in a CRLF.
+    int64_t getLfLineCount() const { return m_lf_lines; }
+    int64_t getCrlfLineCount() const { return m_crlf_lines; }
+    // True if some lines so far end in a LF and others in a CRLF.
+    bool hasMixedLineEndings() const { return m_lf_lines > 0 && m_crlf_lines > 0; }
+    // The line ending of the first line.
+    std::string getLineEnding() const;
+    std::string getName() const { return m_name; }
+    // The pretty line ending of the last line returned by nextLine(). A last line
+    // without a line ending takes the line ending of the first line.
+    const char* getPrettyLE() const;
+    // True if the last line returned by nextLine() ends in a CRLF.
+    bool endsInCrlf() const { return m_line_crlf; }
+    // False if the last line returned by nextLine() is the last line of the
+    // input and has no line ending.
+    bool endsInNewline() const { return !m_line_unterminated; }
+    // True if reading (or decompressing) the input failed.
+    bool hasError() const;
+    // The compression of the input, detected when it was opened.
+    Compression getCompression() const { return m_compression; }
+
+  private:
+    // A read-ahead buffer.
+    struct Buffer
+    {
+        char* data = nullptr;
+        size_t size = 0;
+    };
+
+    // The loop of the read-ahead thread.
+    void readLoop();
+    // Fill a read-ahead buffer with the next raw or decompressed bytes.
+    size_t fillBuffer(char* data, bool& eof, bool& error);
+    // Read the next block of raw input into m_input.
+    bool readInput();
+    // Wait until count buffers in total were filled. Returns false if the input ended first.
+    bool waitFilled(uint64_t count);
+    // Give the buffer that is being consumed back to the read-ahead thread.
+    void releaseCurrent();
+    // Find the first LF in the read-ahead buffers to pick the line ending.
+    bool detectLineEnding();
+
+  private:
+    std::string m_name;
+    int m_fd = -1;
+    bool m_own_fd = false;
+    std::vector<Buffer> m_ring;
+    std::thread m_thread;
+    Compression m_compression = Compression::NONE;
+
+    // Raw input, used by the read-ahead thread once it runs. It holds the bytes
+    // read to detect the compression, and the compressed input after that.
+    std::vector<char> m_input;
+    size_t m_input_pos = 0;
+    size_t m_input_size = 0;
+    bool m_input_eof = false;
+    Decompressor m_decompressor;
+
+    // Shared with the read-ahead thread.
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    // Buffers filled by the thread and released by the consumer, in total.
+    uint64_t m_filled = 0;
+    uint64_t m_released = 0;
+    bool m_eof = false;
+    bool m_error = false;
+    bool m_stopping = false;
+
+    // Consumer state.
+    // The number (not the ring slot) of the buffer that is being consumed.
+    uint64_t m_current = 0;
+    bool m_have_current = false;
+    size_t m_pos = 0;
+    // A line that spans buffers is put together here.
+    std::string m_carry;
+    bool m_carry_pending = false;
+    bool m_carry_returned = false;
+    int64_t m_line_count = 0;
+    int64_t m_lf_lines = 0;
+    int64_t m_crlf_lines = 0;
+    // The line ending of the first line and of the last line returned.
+    bool m_crlf = false;
+    bool m_line_crlf = false;
+    bool m_line_unterminated = false;
+};
+
+} // namespace AbeCmp
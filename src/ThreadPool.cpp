@@ -0,0 +1,129 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "ThreadPool.h"
+
+namespace AbeCmp {
+
+namespace {
+
+// The pool and queue index of the worker running on this thread, if any.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads)
+{
+    if (threads == 0)
+        threads = 1;
+    for (size_t i = 0; i < threads; ++i)
+        m_queues.push_back(std::make_unique<Queue>());
+    m_threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i)
+        m_threads.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_task_ready.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+void
+ThreadPool::submit(Task task)
+{
+    // Count the task before it can be taken, so the counters never run behind.
+    size_t index;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        index = (current_pool == this) ? current_queue : m_next_queue++ % m_queues.size();
+        ++m_queued;
+        ++m_pending;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+        m_queues[index]->tasks.push_back(std::move(task));
+    }
+    m_task_ready.notify_one();
+}
+
+void
+ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+bool
+ThreadPool::takeTask(size_t index, Task& task)
+{
+    {
+        Queue& own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.front());
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    for (size_t k = 1; k < m_queues.size(); ++k) {
+        Queue& victim = *m_queues[(index + k) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+// @brief Run tasks until the pool is stopping and every queue is empty.
+//        A worker only sleeps when no queue holds a task.
+void
+ThreadPool::workerLoop(size_t index)
+{
+    current_pool = this;
+    current_queue = index;
+    for (;;) {
+        Task task;
+        if (takeTask(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_queued;
+            }
+            task();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0)
+                m_idle.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_task_ready.wait(lock, [this] { return m_stopping || m_queued > 0; });
+        if (m_stopping && m_queued == 0)
+            return;
+    }
+}
+
+} // namespace AbeCmp
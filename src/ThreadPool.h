@@ -0,0 +1,84 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// System includes.
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AbeCmp {
+
+// A fixed size pool of worker threads with a work stealing scheduler.
+// Each worker has its own task queue: tasks submitted from a worker go to the back
+// of that worker's queue, tasks submitted from outside are dealt out round robin.
+// A worker runs its own tasks oldest first, so results come out roughly in submit
+// order, and steals the newest task of another worker when its own queue is empty.
+class ThreadPool
+{
+  public:
+    using Task = std::function<void()>;
+
+    // Start the given number of worker threads (at least one).
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Queue a task to run on one of the workers.
+    void submit(Task task);
+    // Block until every queued task has finished.
+    void wait();
+    size_t getThreadCount() const { return m_threads.size(); }
+
+  private:
+    // A worker's own queue of tasks.
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    // The loop each worker runs until the pool is destroyed.
+    void workerLoop(size_t index);
+    // Take the oldest task from the worker's own queue, or steal the newest from another.
+    bool takeTask(size_t index, Task& task);
+
+  private:
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    // Picks the queue for tasks submitted from outside the pool.
+    size_t m_next_queue = 0;
+    std::mutex m_mutex;
+    // Signals workers that a task was queued or the pool is stopping.
+    std::condition_variable m_task_ready;
+    // Signals wait() that the last running task finished.
+    std::condition_variable m_idle;
+    // Tasks sitting in a queue.
+    size_t m_queued = 0;
+    // Tasks that are queued or running.
+    size_t m_pending = 0;
+    bool m_stopping = false;
+};
+
+} // namespace AbeCmp
@@ -40,10 +40,17 @@ class Timer
         }
     }
 
-    void printElapsed(const std::string& label = "Elapsed time") const
+    // The elapsed time in seconds, for rates like MB/s.
+    double getElapsedSeconds() const
+    {
+        const auto end = m_running ? std::chrono::steady_clock::now() : m_end_time;
+        return std::chrono::duration<double>(end - m_start_time).count();
+    }
+
+    void printElapsed(const std::string& label = "Elapsed time", std::ostream& out = std::cout) const
     {
         if (m_running) {
-            std::cout << label << ": timer is still running. Call stop() first.\n";
+            out << label << ": timer is still running. Call stop() first.\n";
             return;
         }
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(m_end_time - m_start_time);
@@ -51,14 +58,14 @@ class Timer
         auto s = (duration.count() / 1000) % 60;
         auto m = (duration.count() / (1000 * 60)) % 60;
         auto h = (duration.count() / (1000 * 60 * 60));
-        std::cout << label << ": ";
+        out << label << ": ";
         if (h > 0)
-            std::cout << h << "h ";
+            out << h << "h ";
         if (m > 0 || h > 0)
-            std::cout << m << "m ";
+            out << m << "m ";
         if (s > 0 || m > 0 || h > 0)
-            std::cout << s << "s ";
-        std::cout << ms << "ms\n";
+            out << s << "s ";
+        out << ms << "ms\n";
     }
 
   private:
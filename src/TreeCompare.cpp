@@ -0,0 +1,351 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#include "TreeCompare.h"
+#include "Compare.h"
+#include "File.h"
+#include "ThreadPool.h"
+
+// System includes.
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace AbeCmp {
+
+namespace {
+
+// Pairs of small files are batched into one task until they add up to this many bytes.
+const uintmax_t batch_bytes = 4 * 1024 * 1024;
+// The most pairs in one batch, so a tree of tiny files still spreads over the pool.
+const size_t batch_pairs = 64;
+
+// What became of one relative path.
+enum class Status
+{
+    MATCH,
+    DIFFER,
+    ERROR,
+    ONLY_A,
+    ONLY_B
+};
+
+// One relative path found in either tree and the result of comparing it.
+struct Entry
+{
+    std::string path;
+    Status status = Status::MATCH;
+    uintmax_t size = 0;
+    // A short note for the report, like the number of differing lines.
+    std::string detail;
+    // The "@@" records, unless the output is quiet.
+    std::string records;
+};
+
+// @brief List the regular files under dir as sorted generic relative paths.
+bool
+listFiles(const fs::path& dir, std::vector<std::string>& files)
+{
+    std::error_code ec;
+    fs::recursive_directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+    if (ec)
+        return false;
+    for (const fs::recursive_directory_iterator end; it != end; it.increment(ec)) {
+        if (ec)
+            return false;
+        // Scan entries kept next to the files aren't part of the tree.
+        if (it->is_regular_file(ec) && !ScanCache::isSidecar(it->path().string()))
+            files.push_back(it->path().lexically_relative(dir).generic_string());
+    }
+    std::sort(files.begin(), files.end());
+    return true;
+}
+
+// @brief Fill in the entry of a file that couldn't be opened as text.
+//        Files without a line ending can't be compared as text, unless both are empty.
+void
+setOpenError(const fs::path& path_a, const fs::path& path_b, Entry& entry)
+{
+    std::error_code ec_a, ec_b;
+    const uintmax_t size_a = fs::file_size(path_a, ec_a);
+    const uintmax_t size_b = fs::file_size(path_b, ec_b);
+    if (!ec_a && !ec_b && size_a == 0 && size_b == 0) {
+        entry.status = Status::MATCH;
+    } else {
+        entry.status = Status::ERROR;
+        entry.detail = (ec_a || ec_b) ? "can't be opened" : "can't be compared as text";
+    }
+}
+
+// @brief Compare two open files the way a single run would and fill in the entry.
+//        Only reads the files, so one file may be compared on several threads at once.
+//        ids_a are the line ids of file a when they were hashed before.
+void
+compareOpened(const File& file_a, const File& file_b, const TreeOptions& options, Entry& entry, const FileLineIds* ids_a = nullptr)
+{
+    const bool positional = (options.algorithm == DiffAlgorithm::POSITIONAL);
+
+    const bool diff_line_endings = lineEndingsDiffer(file_a, file_b);
+    const bool with_pretty_le = diff_line_endings && !options.le_ignore;
+    if (!options.naive && positional && file_a.getLineCount() != file_b.getLineCount()) {
+        entry.status = Status::DIFFER;
+        entry.detail = "line counts do not match: " + std::to_string(file_a.getLineCount()) + " vs " + std::to_string(file_b.getLineCount());
+        return;
+    }
+
+    const MatchPoint start = findFirstDifference(file_a, file_b, options.le_ignore && diff_line_endings);
+    if (start.identical) {
+        entry.status = Status::MATCH;
+        return;
+    }
+
+    if (!positional) {
+        const std::vector<Hunk> hunks = diffFiles(file_a, file_b, start, options.algorithm, options.le_ignore, options.normalization, ids_a);
+        size_t shown = hunks.size();
+        if (options.max_diffs > 0)
+            shown = std::min(shown, static_cast<size_t>(options.max_diffs));
+        for (size_t i = 0; i < shown && !options.quiet; ++i)
+            appendHunk(entry.records, file_a, file_b, hunks[i], static_cast<int64_t>(i) + 1, with_pretty_le);
+        entry.status = hunks.empty() ? Status::MATCH : Status::DIFFER;
+        entry.detail = std::to_string(hunks.size()) + " hunks differ";
+        return;
+    }
+
+    CompareOptions compare_options;
+    compare_options.le_ignore = options.le_ignore;
+    compare_options.with_pretty_le = with_pretty_le;
+    compare_options.keep_lines = !options.quiet;
+    compare_options.normalization = options.normalization;
+    // The pairs are already spread over the pool.
+    compare_options.jobs = 1;
+    const long shortest_line_count = std::min(file_a.getLineCount(), file_b.getLineCount());
+    long line_diffs = 0;
+    bool stopped = false;
+    compareLines(file_a, file_b, start, shortest_line_count, compare_options, [&](const LineDiff& diff) {
+        if (options.max_diffs > 0 && line_diffs == options.max_diffs) {
+            stopped = true;
+            return false;
+        }
+        ++line_diffs;
+        if (!options.quiet)
+            appendLineDiff(entry.records, diff, line_diffs);
+        return true;
+    });
+    entry.status = (line_diffs == 0) ? Status::MATCH : Status::DIFFER;
+    if (stopped)
+        entry.detail = "stopped after " + std::to_string(line_diffs) + " different lines";
+    else
+        entry.detail = std::to_string(line_diffs) + " of " + std::to_string(shortest_line_count) + " lines were different";
+}
+
+// @brief Compare one pair of files the way a single run would and fill in the entry.
+void
+comparePair(const fs::path& path_a, const fs::path& path_b, const TreeOptions& options, Entry& entry)
+{
+    const bool positional = (options.algorithm == DiffAlgorithm::POSITIONAL);
+    File file_a, file_b;
+    if (!file_a.open(path_a.string(), !positional, options.cache) || !file_b.open(path_b.string(), !positional, options.cache)) {
+        setOpenError(path_a, path_b, entry);
+        return;
+    }
+    compareOpened(file_a, file_b, options, entry);
+}
+
+// @brief Print the records of an entry that has any.
+void
+printRecords(const Entry& entry)
+{
+    if (!entry.records.empty())
+        std::cout << "\n" << entry.records;
+}
+
+} // namespace
+
+// @brief Compare one pair of files, as a tree comparison compares each of its pairs.
+void
+compareFiles(const std::string& path_a, const std::string& path_b, const TreeOptions& options, PairResult& result)
+{
+    Entry entry;
+    comparePair(path_a, path_b, options, entry);
+    result.status = (entry.status == Status::MATCH) ? PairStatus::MATCH : (entry.status == Status::DIFFER) ? PairStatus::DIFFER : PairStatus::ERROR;
+    result.detail = std::move(entry.detail);
+    result.records = std::move(entry.records);
+}
+
+// @brief Compare two directory trees.
+//        Both sorted file lists are merged to pair files by relative path. Small
+//        pairs are batched into one task so they don't drown the pool in tiny
+//        tasks. Every task writes only to its own entries, and the report is
+//        printed in path order once the pool is done.
+bool
+compareTrees(const std::string& dir_a, const std::string& dir_b, const TreeOptions& options, TreeSummary& summary)
+{
+    std::vector<std::string> files_a, files_b;
+    if (!listFiles(dir_a, files_a)) {
+        std::cerr << "\nerror: Reading directory: " << dir_a << "\n";
+        return false;
+    }
+    if (!listFiles(dir_b, files_b)) {
+        std::cerr << "\nerror: Reading directory: " << dir_b << "\n";
+        return false;
+    }
+
+    // Merge the sorted lists.
+    std::vector<Entry> entries;
+    entries.reserve(std::max(files_a.size(), files_b.size()));
+    size_t ia = 0, ib = 0;
+    while (ia < files_a.size() || ib < files_b.size()) {
+        Entry entry;
+        if (ib == files_b.size() || (ia < files_a.size() && files_a[ia] < files_b[ib])) {
+            entry.path = files_a[ia++];
+            entry.status = Status::ONLY_A;
+        } else if (ia == files_a.size() || files_b[ib] < files_a[ia]) {
+            entry.path = files_b[ib++];
+            entry.status = Status::ONLY_B;
+        } else {
+            entry.path = files_a[ia++];
+            ++ib;
+            std::error_code ec;
+            entry.size = std::max(fs::file_size(fs::path(dir_a) / entry.path, ec), fs::file_size(fs::path(dir_b) / entry.path, ec));
+        }
+        entries.push_back(std::move(entry));
+    }
+
+    {
+        ThreadPool pool(options.jobs);
+        std::vector<size_t> batch;
+        uintmax_t batch_size = 0;
+        auto submitBatch = [&]() {
+            if (batch.empty())
+                return;
+            pool.submit([&entries, &options, &dir_a, &dir_b, batch] {
+                for (const size_t i : batch)
+                    comparePair(fs::path(dir_a) / entries[i].path, fs::path(dir_b) / entries[i].path, options, entries[i]);
+            });
+            batch.clear();
+            batch_size = 0;
+        };
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].status == Status::ONLY_A || entries[i].status == Status::ONLY_B)
+                continue;
+            // A large pair gets a task of its own.
+            if (entries[i].size >= batch_bytes)
+                submitBatch();
+            batch.push_back(i);
+            batch_size += entries[i].size;
+            if (batch_size >= batch_bytes || batch.size() >= batch_pairs)
+                submitBatch();
+        }
+        submitBatch();
+        pool.wait();
+    }
+
+    std::cout << "\nDir a: " << dir_a;
+    std::cout << "\nDir b: " << dir_b << "\n\n";
+    for (const auto& entry : entries) {
+        switch (entry.status) {
+            case Status::MATCH:
+                ++summary.matched;
+                break;
+            case Status::DIFFER:
+                ++summary.differed;
+                std::cout << "Differ: " << entry.path << " (" << entry.detail << ")\n";
+                printRecords(entry);
+                break;
+            case Status::ERROR:
+                ++summary.errors;
+                std::cout << "Error: " << entry.path << " (" << entry.detail << ")\n";
+                break;
+            case Status::ONLY_A:
+                ++summary.only_a;
+                std::cout << "Only in a: " << entry.path << "\n";
+                break;
+            case Status::ONLY_B:
+                ++summary.only_b;
+                std::cout << "Only in b: " << entry.path << "\n";
+                break;
+        }
+    }
+    return true;
+}
+
+// @brief Compare one reference file with many candidates.
+//        The reference is opened, scanned and (for a diff algorithm) hashed once,
+//        then shared read-only by the pool threads, which open and compare one
+//        candidate each. The report has one row per candidate, in the given order.
+bool
+compareMany(const std::string& reference, const std::vector<std::string>& candidates, const TreeOptions& options, TreeSummary& summary)
+{
+    const bool positional = (options.algorithm == DiffAlgorithm::POSITIONAL);
+    File file_a;
+    if (!file_a.open(reference, !positional, options.cache)) {
+        std::cerr << "\nerror: Opening file: " << reference << "\n";
+        return false;
+    }
+
+    // Hash the reference lines once, not again for every candidate.
+    FileLineIds ids_a;
+    if (!positional)
+        hashFileLines(file_a, options.normalization, options.le_ignore, ids_a);
+
+    std::vector<Entry> entries(candidates.size());
+    {
+        ThreadPool pool(options.jobs);
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            entries[i].path = candidates[i];
+            pool.submit([&file_a, &ids_a, &options, positional, &entry = entries[i]] {
+                File file_b;
+                if (file_b.open(entry.path, !positional, options.cache))
+                    compareOpened(file_a, file_b, options, entry, &ids_a);
+                else
+                    setOpenError(file_a.getName(), entry.path, entry);
+            });
+        }
+        pool.wait();
+    }
+
+    std::cout << "\nReference [" << file_a.getLineEnding() << "]: " << reference;
+    std::cout << "\nCandidates: " << candidates.size() << "\n\n";
+    for (const auto& entry : entries) {
+        switch (entry.status) {
+            case Status::MATCH:
+                ++summary.matched;
+                std::cout << "Match:  " << entry.path << "\n";
+                break;
+            case Status::DIFFER:
+                ++summary.differed;
+                std::cout << "Differ: " << entry.path << " (" << entry.detail << ")\n";
+                printRecords(entry);
+                break;
+            case Status::ERROR:
+                ++summary.errors;
+                std::cout << "Error:  " << entry.path << " (" << entry.detail << ")\n";
+                break;
+            case Status::ONLY_A:
+            case Status::ONLY_B:
+                break;
+        }
+    }
+    return true;
+}
+
+} // namespace AbeCmp
@@ -0,0 +1,90 @@
+/**
+ *        d8888 888                .d8888b.
+ *       d88888 888               d88P  Y88b
+ *      d88P888 888               888    888
+ *     d88P 888 88888b.   .d88b.  888        88888b.d88b.  88888b.
+ *    d88P  888 888 "88b d8P  Y8b 888        888 "888 "88b 888 "88b
+ *   d88P   888 888  888 88888888 888    888 888  888  888 888  888
+ *  d8888888888 888 d88P Y8b.     Y88b  d88P 888  888  888 888 d88P
+ * d88P     888 88888P"   "Y8888   "Y8888P"  888  888  888 88888P"
+ *                                                         888
+ * A simple file comparison tool                           888
+ *                                                         888
+ * Copyright (c) 2025, Abe Mishler
+ * Licensed under the Universal Permissive License v 1.0
+ * as shown at https://oss.oracle.com/licenses/upl/.
+ */
+
+#pragma once
+
+// Project includes.
+#include "Diff.h"
+#include "ScanCache.h"
+
+// System includes.
+#include <string>
+#include <vector>
+
+namespace AbeCmp {
+
+// Options shared by every pair of files in a directory tree comparison, or in a
+// comparison of one reference file with many candidates.
+struct TreeOptions
+{
+    bool le_ignore = false;
+    bool naive = false;
+    bool quiet = false;
+    DiffAlgorithm algorithm = DiffAlgorithm::POSITIONAL;
+    // The number of threads comparing file pairs.
+    unsigned jobs = 1;
+    // Stop reporting a file pair after this many differences (0 for no limit).
+    long max_diffs = 0;
+    // Differences between lines that don't count.
+    Normalization normalization;
+    // Reuse the scan results of unchanged files, if set.
+    const ScanCache* cache = nullptr;
+};
+
+// The totals of a directory tree comparison or of a one-to-many comparison.
+struct TreeSummary
+{
+    long matched = 0;
+    long differed = 0;
+    long errors = 0;
+    long only_a = 0;
+    long only_b = 0;
+};
+
+// What became of one pair of files.
+enum class PairStatus
+{
+    MATCH,
+    DIFFER,
+    ERROR
+};
+
+// The result of comparing one pair of files.
+struct PairResult
+{
+    PairStatus status = PairStatus::MATCH;
+    // A short note, like the number of differing lines.
+    std::string detail;
+    // The "@@" records, unless the output is quiet.
+    std::string records;
+};
+
+// Compare one pair of files the way a single run would, with the tree options.
+// Only reads the files, so pairs can be compared on several threads at once.
+void compareFiles(const std::string& path_a, const std::string& path_b, const TreeOptions& options, PairResult& result);
+
+// Walk both trees, pair up files by their relative path and compare the pairs on a
+// work stealing thread pool. Prints one report in path order.
+// Returns false if either tree can't be read.
+bool compareTrees(const std::string& dir_a, const std::string& dir_b, const TreeOptions& options, TreeSummary& summary);
+
+// Compare one reference file with each candidate on a thread pool. The reference
+// is opened and scanned once and shared by all threads. Prints one row per
+// candidate, in order. Returns false if the reference can't be opened.
+bool compareMany(const std::string& reference, const std::vector<std::string>& candidates, const TreeOptions& options, TreeSummary& summary);
+
+} // namespace AbeCmp
@@ -17,26 +17,44 @@
 
 // Project includes
 #include "AbeCmpConfig.h"
+#include "BinaryCompare.h"
+#include "Compare.h"
+#include "Diff.h"
+#include "DiffWriter.h"
+#include "ExternalDiff.h"
 #include "File.h"
+#include "Follow.h"
 #include "Platform.h"
+#include "Server.h"
+#include "Similarity.h"
+#include "Stats.h"
+#include "StreamReader.h"
 #include "Timer.h"
+#include "TreeCompare.h"
 
 // AbeArgs includes
 #include "abeargs.h"
 
 // System includes
+#include <cerrno>
+#include <csignal>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 void
-showAbout(int lines = 2)
+showAbout(int lines = 2, FILE* out = stdout)
 {
-    printf("AbeCmp v%s (%s %s), %s %s\n", ABECMP_VERSION, AbeCmp::getArch(), AbeCmp::getHostType(), __DATE__, __TIME__);
+    fprintf(out, "AbeCmp v%s (%s %s), %s %s\n", ABECMP_VERSION, AbeCmp::getArch(), AbeCmp::getHostType(), __DATE__, __TIME__);
     if (lines == 1)
         return;
 
-    printf("A simple file comparison tool.\n");
+    fprintf(out, "A simple file comparison tool.\n");
 }
 
 void
@@ -56,6 +74,624 @@ showHelp(const AbeArgs::Parser& parser)
     printf("\n");
 }
 
+// @brief Parse a line number given on the command line. Line numbers are 64-bit,
+//        so they don't go through the int arguments of the parser.
+bool
+parseLineNumber(const std::string& text, int64_t& line)
+{
+    char* end = nullptr;
+    errno = 0;
+    const long long value = strtoll(text.c_str(), &end, 10);
+    if (errno != 0 || end == text.c_str() || *end != '\0' || value < 0)
+        return false;
+    line = value;
+    return true;
+}
+
+// @brief Read the candidate paths of a one-to-many comparison, one per line.
+//        Blank lines and lines starting with # are skipped.
+bool
+readManifest(const std::string& name, std::vector<std::string>& paths)
+{
+    std::ifstream in(name);
+    if (!in.is_open())
+        return false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty() && line[0] != '#')
+            paths.push_back(line);
+    }
+    return !in.bad();
+}
+
+// @brief Print the --stats report: a JSON object with the JSON format,
+//        otherwise a table with the rest of the report.
+void
+showStats(AbeCmp::DiffWriter* writer, std::ostream& info_os)
+{
+    if (!AbeCmp::Stats::enabled())
+        return;
+    if (writer != nullptr && writer->getFormat() == AbeCmp::OutputFormat::JSON) {
+        writer->writeStats();
+        writer->flush();
+    } else {
+        info_os << AbeCmp::Stats::formatText();
+    }
+}
+
+// @brief Print how many lines use each line ending, for an input that mixes them.
+template<typename Input>
+void
+showMixedLineEndings(const char* label, const Input& input, FILE* out)
+{
+    if (input.hasMixedLineEndings())
+        fprintf(out, "File %s mixes line endings: %lld lines end in lf, %lld in crlf.\n", label, static_cast<long long>(input.getLfLineCount()),
+                static_cast<long long>(input.getCrlfLineCount()));
+}
+
+// @brief Print the compression of an input that is decompressed while it is read.
+template<typename Input>
+void
+showCompression(const char* label, const Input& input, FILE* out)
+{
+    if (input.getCompression() != AbeCmp::Compression::NONE)
+        fprintf(out, "File %s is %s compressed.\n", label, AbeCmp::getCompressionName(input.getCompression()));
+}
+
+// @brief Compare two inputs line by line as they are read.
+//        Streams are read only once, so the line counts are checked after the
+//        lines were compared instead of before.
+int
+compareStreams(const std::string& name_a, const std::string& name_b, bool le_ignore, const AbeCmp::Normalization& normalization, bool naive, bool quiet, AbeCmp::OutputFormat format, long max_diffs)
+{
+    AbeCmp::StreamReader stream_a, stream_b;
+    if (name_a == "-" && name_b == "-") {
+        std::cerr << "\nerror: Only one file can be read from stdin.\n";
+        return EXIT_FAILURE;
+    }
+    if (!stream_a.open(name_a)) {
+        std::cerr << "\nerror: Opening file: " << stream_a.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+    if (!stream_b.open(name_b)) {
+        std::cerr << "\nerror: Opening file: " << stream_b.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // Machine-readable formats keep stdout for the differences.
+    const bool text = (format == AbeCmp::OutputFormat::TEXT);
+    FILE* info = text ? stdout : stderr;
+    std::ostream& info_os = text ? std::cout : std::cerr;
+    AbeCmp::DiffWriter writer(format);
+
+    Timer timer;
+    timer.start();
+
+    const bool diff_line_endings = (stream_a.getLineEnding() != stream_b.getLineEnding());
+    info_os << "\nFile a [" << stream_a.getLineEnding() << "]: " << stream_a.getName();
+    info_os << "\nFile b [" << stream_b.getLineEnding() << "]: " << stream_b.getName() << "\n";
+    showCompression("a", stream_a, info);
+    showCompression("b", stream_b, info);
+    if (diff_line_endings)
+        fprintf(info, "The files use different line endings.\n");
+    if (le_ignore)
+        fprintf(info, "Ignoring line ending differences.\n");
+    if (normalization.any())
+        fprintf(info, "Ignoring %s.\n", AbeCmp::describeNormalization(normalization).c_str());
+    writer.writeHeader(stream_a.getName(), stream_b.getName());
+
+    AbeCmp::CompareOptions options;
+    options.le_ignore = le_ignore;
+    options.with_pretty_le = diff_line_endings && !le_ignore;
+    options.keep_lines = !quiet;
+    options.normalization = normalization;
+
+    int64_t line_diffs = 0;
+    bool stopped = false;
+    const AbeCmp::StreamCompareResult result = AbeCmp::compareStreams(stream_a, stream_b, naive, options, [&](const AbeCmp::LineDiff& diff) {
+        if (max_diffs > 0 && line_diffs == max_diffs) {
+            stopped = true;
+            return false;
+        }
+        line_diffs++;
+        if (!quiet)
+            writer.writeLineDiff(diff, line_diffs);
+        return true;
+    });
+    writer.flush();
+    if (stream_a.hasError() || stream_b.hasError()) {
+        std::cerr << "\nerror: Reading file: " << (stream_a.hasError() ? stream_a.getName() : stream_b.getName()) << "\n";
+        return EXIT_FAILURE;
+    }
+
+    if (quiet)
+        fprintf(info, "\n");
+    showMixedLineEndings("a", stream_a, info);
+    showMixedLineEndings("b", stream_b, info);
+
+    AbeCmp::OutputSummary summary;
+    summary.compared = result.compared;
+    summary.differences = line_diffs;
+    summary.stopped = stopped;
+    if (!naive && !stopped && stream_a.getLineCount() != stream_b.getLineCount()) {
+        fprintf(info, "\nThe files are not the same because the line counts do not match.");
+        info_os << "\nFile a: " << stream_a.getLineCount() << (stream_a.getLineCount() == 1 ? " line." : " lines.");
+        info_os << "\nFile b: " << stream_b.getLineCount() << (stream_b.getLineCount() == 1 ? " line.\n" : " lines.\n");
+        summary.line_counts_differ = true;
+        summary.lines_a = stream_a.getLineCount();
+        summary.lines_b = stream_b.getLineCount();
+    } else if (line_diffs == 0) {
+        if (diff_line_endings)
+            fprintf(info, "\nThe file contents match, but they have different line endings.\n");
+        else
+            fprintf(info, "\nThe files match");
+
+        if (naive)
+            fprintf(info, " up to line %lld.\n", static_cast<long long>(result.compared));
+        else
+            fprintf(info, " and have the same line count.\n");
+
+        fprintf(info, "%lld lines were compared.\n", static_cast<long long>(result.compared));
+        summary.match = true;
+    } else {
+        fprintf(info, "The files don't match.\n");
+        if (stopped)
+            fprintf(info, "Stopped after %lld different lines.\n", static_cast<long long>(line_diffs));
+        else
+            fprintf(info, "%lld of %lld lines were different.\n", static_cast<long long>(line_diffs), static_cast<long long>(result.compared));
+    }
+    writer.writeSummary(summary);
+    writer.flush();
+
+    timer.stop();
+    timer.printElapsed("Total time taken", info_os);
+    showStats(&writer, info_os);
+    return EXIT_SUCCESS;
+}
+
+// @brief Estimate how similar two inputs are from MinHash signatures of their
+//        line shingles, reading each input once.
+int
+compareSimilarity(const std::string& name_a, const std::string& name_b, const AbeCmp::Normalization& normalization, long shingle_lines, AbeCmp::OutputFormat format)
+{
+    AbeCmp::StreamReader stream_a, stream_b;
+    if (name_a == "-" && name_b == "-") {
+        std::cerr << "\nerror: Only one file can be read from stdin.\n";
+        return EXIT_FAILURE;
+    }
+    if (!stream_a.open(name_a)) {
+        std::cerr << "\nerror: Opening file: " << stream_a.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+    if (!stream_b.open(name_b)) {
+        std::cerr << "\nerror: Opening file: " << stream_b.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    const bool text = (format == AbeCmp::OutputFormat::TEXT);
+    FILE* info = text ? stdout : stderr;
+    std::ostream& info_os = text ? std::cout : std::cerr;
+    AbeCmp::DiffWriter writer(format);
+
+    Timer timer;
+    timer.start();
+
+    info_os << "\nFile a [" << stream_a.getLineEnding() << "]: " << stream_a.getName();
+    info_os << "\nFile b [" << stream_b.getLineEnding() << "]: " << stream_b.getName() << "\n";
+    showCompression("a", stream_a, info);
+    showCompression("b", stream_b, info);
+    if (normalization.any())
+        fprintf(info, "Ignoring %s.\n", AbeCmp::describeNormalization(normalization).c_str());
+    fprintf(info, "Estimating the similarity of %ld-line shingles from %zu-bucket MinHash signatures.\n", shingle_lines,
+            AbeCmp::MinHashSketch::buckets);
+    writer.writeHeader(stream_a.getName(), stream_b.getName());
+
+    AbeCmp::SimilarityOptions options;
+    options.shingle_lines = shingle_lines;
+    options.normalization = normalization;
+    AbeCmp::SimilarityResult result;
+    if (!AbeCmp::compareSimilarity(stream_a, stream_b, options, result)) {
+        std::cerr << "\nerror: Reading file: " << (stream_a.hasError() ? stream_a.getName() : stream_b.getName()) << "\n";
+        return EXIT_FAILURE;
+    }
+    writer.writeSimilarity(result);
+    writer.flush();
+
+    fprintf(info, "\nThe files are about %.1f%% similar.\n", 100.0 * result.similarity);
+    info_os << "File a: " << result.lines_a << (result.lines_a == 1 ? " line." : " lines.");
+    info_os << "\nFile b: " << result.lines_b << (result.lines_b == 1 ? " line.\n" : " lines.\n");
+
+    timer.stop();
+    timer.printElapsed("Total time taken", info_os);
+    showStats(&writer, info_os);
+    return EXIT_SUCCESS;
+}
+
+// @brief Diff two files within a memory limit, with the line hashes sorted
+//        on disk instead of held in memory, for files larger than memory.
+int
+compareExternal(const std::string& name_a, const std::string& name_b, AbeCmp::DiffAlgorithm algorithm, bool le_ignore, const AbeCmp::Normalization& normalization, bool quiet,
+                AbeCmp::OutputFormat format, long max_diffs, uint64_t memory_limit)
+{
+    if (AbeCmp::StreamReader::isStream(name_a) || AbeCmp::StreamReader::isStream(name_b)) {
+        std::cerr << "\nerror: A diff within a memory limit reads each file twice, so it needs files, not streams.\n";
+        return EXIT_FAILURE;
+    }
+
+    const bool text = (format == AbeCmp::OutputFormat::TEXT);
+    FILE* info = text ? stdout : stderr;
+    std::ostream& info_os = text ? std::cout : std::cerr;
+    AbeCmp::DiffWriter writer(format);
+
+    Timer timer;
+    timer.start();
+
+    // The files are read by the diff, so only peek at their first line here.
+    std::string display_a, display_b;
+    bool diff_line_endings = false;
+    {
+        AbeCmp::StreamReader stream_a, stream_b;
+        if (!stream_a.open(name_a)) {
+            std::cerr << "\nerror: Opening file: " << stream_a.getName() << "\n";
+            return EXIT_FAILURE;
+        }
+        if (!stream_b.open(name_b)) {
+            std::cerr << "\nerror: Opening file: " << stream_b.getName() << "\n";
+            return EXIT_FAILURE;
+        }
+        display_a = stream_a.getName();
+        display_b = stream_b.getName();
+        diff_line_endings = (stream_a.getLineEnding() != stream_b.getLineEnding());
+        info_os << "\nFile a [" << stream_a.getLineEnding() << "]: " << display_a;
+        info_os << "\nFile b [" << stream_b.getLineEnding() << "]: " << display_b << "\n";
+        showCompression("a", stream_a, info);
+        showCompression("b", stream_b, info);
+    }
+    if (diff_line_endings)
+        fprintf(info, "The files use different line endings.\n");
+    if (le_ignore)
+        fprintf(info, "Ignoring line ending differences.\n");
+    if (normalization.any())
+        fprintf(info, "Ignoring %s.\n", AbeCmp::describeNormalization(normalization).c_str());
+    fprintf(info, "Diffing within a memory limit of %llu MiB.\n", static_cast<unsigned long long>(memory_limit >> 20));
+    writer.writeHeader(display_a, display_b);
+
+    AbeCmp::ExternalDiffOptions options;
+    options.memory_limit = memory_limit;
+    options.algorithm = algorithm;
+    options.le_ignore = le_ignore;
+    // A unified diff carries the raw line endings, so that patch can apply it.
+    options.with_pretty_le = diff_line_endings && !le_ignore && format != AbeCmp::OutputFormat::UNIFIED;
+    options.with_raw_crlf = (format == AbeCmp::OutputFormat::UNIFIED);
+    options.keep_lines = !quiet;
+    options.normalization = normalization;
+
+    int64_t hunk_count = 0;
+    int64_t lines_only_a = 0;
+    int64_t lines_only_b = 0;
+    int64_t stop_line = 0;
+    AbeCmp::ExternalDiffResult result;
+    const bool ok = AbeCmp::diffExternal(name_a, name_b, options,
+                                         [&](const AbeCmp::Hunk& hunk, const std::vector<std::string>& lines_a, const std::vector<std::string>& lines_b) {
+                                             if (max_diffs > 0 && hunk_count == max_diffs) {
+                                                 stop_line = hunk.a_first;
+                                                 return false;
+                                             }
+                                             ++hunk_count;
+                                             lines_only_a += hunk.a_count;
+                                             lines_only_b += hunk.b_count;
+                                             if (!quiet) {
+                                                 const bool no_newline_a = result.unterminated_a && hunk.a_count > 0 && hunk.a_first + hunk.a_count == result.lines_a;
+                                                 const bool no_newline_b = result.unterminated_b && hunk.b_count > 0 && hunk.b_first + hunk.b_count == result.lines_b;
+                                                 writer.writeHunk(hunk, hunk_count, lines_a, lines_b, no_newline_a, no_newline_b);
+                                             }
+                                             return true;
+                                         },
+                                         result);
+    writer.flush();
+    if (!ok) {
+        std::cerr << "\nerror: Diffing " << display_a << " and " << display_b << " (reading a file or a temporary file failed).\n";
+        return EXIT_FAILURE;
+    }
+
+    if (quiet)
+        fprintf(info, "\n");
+    const int64_t line_count = std::min(result.lines_a, result.lines_b);
+    if (hunk_count == 0) {
+        if (diff_line_endings)
+            fprintf(info, "\nThe file contents match, but they have different line endings.\n");
+        else
+            fprintf(info, "\nThe files match and have the same line count.\n");
+        fprintf(info, "%lld lines were compared.\n", static_cast<long long>(line_count));
+    } else {
+        fprintf(info, "The files don't match.\n");
+        if (result.stopped)
+            fprintf(info, "Stopped after %lld hunks.\n", static_cast<long long>(hunk_count));
+        else
+            fprintf(info, "%lld hunks differ: %lld lines only in file a, %lld lines only in file b.\n", static_cast<long long>(hunk_count), static_cast<long long>(lines_only_a),
+                    static_cast<long long>(lines_only_b));
+    }
+    fprintf(info, "%lld anchor lines, %ld sorted segments (%.1f MiB) on disk", static_cast<long long>(result.anchors), result.segments,
+            static_cast<double>(result.spilled_bytes) / (1 << 20));
+    if (result.approximate_lines > 0)
+        fprintf(info, ", %lld lines between anchors too far apart were diffed piece by piece", static_cast<long long>(result.approximate_lines));
+    fprintf(info, ".\n");
+
+    AbeCmp::OutputSummary summary;
+    summary.match = hunk_count == 0;
+    summary.compared = result.stopped ? stop_line : line_count;
+    summary.differences = hunk_count;
+    summary.stopped = result.stopped;
+    writer.writeSummary(summary);
+    writer.flush();
+
+    timer.stop();
+    timer.printElapsed("Total time taken", info_os);
+    showStats(&writer, info_os);
+    return EXIT_SUCCESS;
+}
+
+// Set by SIGINT or SIGTERM to stop following the files or serving.
+volatile std::sig_atomic_t stop_requested = 0;
+
+void
+requestStop(int)
+{
+    stop_requested = 1;
+}
+
+// @brief Follow two growing files, comparing the lines they gained each time
+//        either changes and reporting new differences as they appear, until
+//        interrupted or --max-diffs is reached.
+int
+compareFollow(const std::string& name_a, const std::string& name_b, bool le_ignore, const AbeCmp::Normalization& normalization, bool quiet, AbeCmp::OutputFormat format,
+              long max_diffs, unsigned threads)
+{
+    AbeCmp::FollowOptions options;
+    options.compare.le_ignore = le_ignore;
+    options.compare.keep_lines = !quiet;
+    options.compare.jobs = threads;
+    options.compare.normalization = normalization;
+    AbeCmp::Follower follower(options);
+    if (!follower.open(name_a, name_b)) {
+        std::cerr << "\nerror: Opening files to follow: " << name_a << ", " << name_b << "\n";
+        return EXIT_FAILURE;
+    }
+
+    const bool text = (format == AbeCmp::OutputFormat::TEXT);
+    FILE* info = text ? stdout : stderr;
+    std::ostream& info_os = text ? std::cout : std::cerr;
+    AbeCmp::DiffWriter writer(format);
+
+    Timer timer;
+    timer.start();
+
+    info_os << "\nFile a: " << name_a;
+    info_os << "\nFile b: " << name_b << "\n";
+    if (le_ignore)
+        fprintf(info, "Ignoring line ending differences.\n");
+    if (normalization.any())
+        fprintf(info, "Ignoring %s.\n", AbeCmp::describeNormalization(normalization).c_str());
+    fprintf(info, "Following the files as they grow, until interrupted.\n");
+    writer.writeHeader(name_a, name_b);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+
+    int64_t line_diffs = 0;
+    // Lines compared by all updates, counting lines compared again after a rescan.
+    int64_t compared = 0;
+    bool stopped = false;
+    int64_t stop_line = 0;
+    const AbeCmp::DiffHandler handler = [&](const AbeCmp::LineDiff& diff) {
+        if (max_diffs > 0 && line_diffs == max_diffs)
+            return false;
+        line_diffs++;
+        if (!quiet)
+            writer.writeLineDiff(diff, line_diffs);
+        return true;
+    };
+    while (!stop_requested) {
+        AbeCmp::FollowUpdate update;
+        const int64_t verified = follower.getLineCount();
+        if (!follower.update(handler, update)) {
+            std::cerr << "\nerror: Reading the files to follow: " << name_a << ", " << name_b << "\n";
+            return EXIT_FAILURE;
+        }
+        writer.flush();
+        compared += update.compared;
+        if (update.rescan)
+            fprintf(info, "%s, comparing from the start again.\n", update.reason.c_str());
+        if (update.stopped) {
+            stopped = true;
+            stop_line = (update.rescan ? 0 : verified) + update.compared;
+            break;
+        }
+        if (update.compared > 0)
+            fprintf(info, "Lines %lld to %lld compared, %lld different.\n", static_cast<long long>(follower.getLineCount() - update.compared + 1),
+                    static_cast<long long>(follower.getLineCount()), static_cast<long long>(update.line_diffs));
+        fflush(info);
+        follower.wait();
+    }
+
+    const int64_t line_count = follower.getLineCount();
+    if (line_diffs == 0) {
+        fprintf(info, "\nThe files match in the %lld lines both have.\n", static_cast<long long>(line_count));
+    } else {
+        fprintf(info, "\nThe files don't match.\n");
+        if (stopped)
+            fprintf(info, "Stopped after %lld different lines.\n", static_cast<long long>(line_diffs));
+        else
+            fprintf(info, "%lld of %lld lines compared were different.\n", static_cast<long long>(line_diffs), static_cast<long long>(compared));
+    }
+
+    AbeCmp::OutputSummary summary;
+    summary.match = line_diffs == 0;
+    summary.compared = stopped ? stop_line : compared;
+    summary.differences = line_diffs;
+    summary.stopped = stopped;
+    writer.writeSummary(summary);
+    writer.flush();
+
+    timer.stop();
+    timer.printElapsed("Total time taken", info_os);
+    showStats(&writer, info_os);
+    return EXIT_SUCCESS;
+}
+
+// @brief Serve batches of comparisons on a Unix domain socket, until interrupted.
+int
+serveComparisons(const std::string& socket_path, const AbeCmp::TreeOptions& options)
+{
+    AbeCmp::CompareServer server(options);
+    if (!server.listen(socket_path)) {
+        std::cerr << "\nerror: Listening on socket: " << socket_path << " (is a server running, or is another file there?)\n";
+        return EXIT_FAILURE;
+    }
+    printf("\nServing comparisons on %s with %u threads, until interrupted.\n", socket_path.c_str(), options.jobs);
+    fflush(stdout);
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    Timer timer;
+    timer.start();
+    server.run([] { return !stop_requested; });
+
+    printf("\n%ld batches of %ld file pairs were compared.\n", server.getBatchCount(), server.getPairCount());
+    timer.stop();
+    timer.printElapsed("Total time taken");
+    showStats(nullptr, std::cout);
+    return EXIT_SUCCESS;
+}
+
+// @brief Send file pairs to a comparison server as one batch and print each
+//        reply as it arrives. The server compares them with its own options.
+int
+compareRemote(const std::string& socket_path, const std::vector<AbeCmp::FilePair>& pairs)
+{
+    AbeCmp::CompareClient client;
+    if (!client.connect(socket_path)) {
+        std::cerr << "\nerror: Connecting to the server at: " << socket_path << "\n";
+        return EXIT_FAILURE;
+    }
+
+    Timer timer;
+    timer.start();
+    printf("\nComparing %zu file pairs on the server at %s.\n\n", pairs.size(), socket_path.c_str());
+    AbeCmp::BatchReply totals;
+    const bool ok = client.compareBatch(pairs, [&](const AbeCmp::PairReply& reply) {
+        const std::string& name = (reply.id >= 0 && static_cast<size_t>(reply.id) < pairs.size()) ? pairs[reply.id].second : std::string("?");
+        switch (reply.result.status) {
+            case AbeCmp::PairStatus::MATCH:
+                std::cout << "Match:  " << name << "\n";
+                break;
+            case AbeCmp::PairStatus::DIFFER:
+                std::cout << "Differ: " << name << " (" << reply.result.detail << ")\n";
+                if (!reply.result.records.empty())
+                    std::cout << "\n" << reply.result.records;
+                break;
+            case AbeCmp::PairStatus::ERROR:
+                std::cout << "Error:  " << name << " (" << reply.result.detail << ")\n";
+                break;
+        }
+    }, totals);
+    if (!ok) {
+        std::cerr << "\nerror: The server connection failed, or a path has a tab or a line feed in it.\n";
+        return EXIT_FAILURE;
+    }
+
+    printf("\n%ld files compared: %ld match, %ld differ, %ld could not be compared.\n", totals.pairs, totals.matched, totals.differed, totals.errors);
+    timer.stop();
+    timer.printElapsed("Total time taken");
+    return EXIT_SUCCESS;
+}
+
+// @brief Compare two files byte by byte and list the differing bytes, like cmp -l.
+//        Only the bytes both files have are compared; a size difference is
+//        reported after them.
+int
+compareBinary(const std::string& name_a, const std::string& name_b, bool quiet, AbeCmp::OutputFormat format, long max_diffs)
+{
+    AbeCmp::File file_a, file_b;
+    if (!file_a.openBytes(name_a)) {
+        std::cerr << "\nerror: Opening file: " << file_a.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+    if (!file_b.openBytes(name_b)) {
+        std::cerr << "\nerror: Opening file: " << file_b.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+
+    const bool text = (format == AbeCmp::OutputFormat::TEXT);
+    FILE* info = text ? stdout : stderr;
+    std::ostream& info_os = text ? std::cout : std::cerr;
+    AbeCmp::DiffWriter writer(format);
+
+    Timer timer;
+    timer.start();
+
+    info_os << "\nFile a [" << file_a.getSize() << " bytes]: " << file_a.getName();
+    info_os << "\nFile b [" << file_b.getSize() << " bytes]: " << file_b.getName() << "\n";
+    writer.writeHeader(file_a.getName(), file_b.getName());
+
+    // Quiet comparisons without a limit only need the count, which the count
+    // kernel gets without stopping at each difference.
+    int64_t byte_diffs = 0;
+    bool stopped = false;
+    AbeCmp::ByteDiffHandler handler;
+    if (!quiet || max_diffs > 0) {
+        handler = [&](const AbeCmp::ByteDiff& diff) {
+            if (max_diffs > 0 && byte_diffs == max_diffs) {
+                stopped = true;
+                return false;
+            }
+            byte_diffs++;
+            if (!quiet)
+                writer.writeByteDiff(diff, byte_diffs);
+            return true;
+        };
+    }
+    const AbeCmp::BinaryCompareResult result = AbeCmp::compareBytes(file_a, file_b, handler);
+    if (!handler)
+        byte_diffs = static_cast<int64_t>(result.differences);
+    writer.flush();
+
+    AbeCmp::OutputSummary summary;
+    summary.compared = static_cast<int64_t>(result.compared);
+    summary.differences = byte_diffs;
+    summary.stopped = stopped;
+    summary.sizes_differ = file_a.getSize() != file_b.getSize();
+    summary.size_a = file_a.getSize();
+    summary.size_b = file_b.getSize();
+    summary.match = byte_diffs == 0 && !summary.sizes_differ;
+
+    fprintf(info, "\n");
+    if (summary.match) {
+        fprintf(info, "The files match.\n");
+    } else {
+        fprintf(info, "The files don't match.\n");
+        if (stopped)
+            fprintf(info, "Stopped after %lld different bytes.\n", static_cast<long long>(byte_diffs));
+        else
+            fprintf(info, "%lld of %llu bytes were different.\n", static_cast<long long>(byte_diffs), static_cast<unsigned long long>(result.compared));
+        if (summary.sizes_differ && !stopped)
+            fprintf(info, "File %s ends after byte %llu, file %s has %llu bytes.\n", file_a.getSize() < file_b.getSize() ? "a" : "b",
+                    static_cast<unsigned long long>(result.compared), file_a.getSize() < file_b.getSize() ? "b" : "a",
+                    static_cast<unsigned long long>(std::max(file_a.getSize(), file_b.getSize())));
+    }
+    if (summary.match || !stopped)
+        fprintf(info, "%llu bytes were compared.\n", static_cast<unsigned long long>(result.compared));
+    writer.writeSummary(summary);
+    writer.flush();
+
+    timer.stop();
+    timer.printElapsed("Total time taken", info_os);
+    showStats(&writer, info_os);
+    return EXIT_SUCCESS;
+}
+
 int
 main(int argc, char** argv)
 {
@@ -66,15 +702,57 @@ main(int argc, char** argv)
     const int FILE_IG_ID = 3; // Ignore differences in line endings.
     const int NAIVE_ID = 4;   // Use a naive comparison (skip the line count check).
     const int QUIET_ID = 5;   // Don't print out any differences.
-    const int VERSION_ID = 6; // Print out version/about information.
-    const int HELP_ID = 7;    // Print out usage help.
+    const int JOBS_ID = 6;    // Number of threads to compare with.
+    const int DIFF_ALG_ID = 7; // How to match up the lines of both files.
+    const int CACHE_ID = 8;   // Directory of the scan cache.
+    const int STREAM_ID = 9;  // Read the files with read-ahead instead of mapping them.
+    const int FORMAT_ID = 10; // How the differences are written out.
+    const int MAX_DIFFS_ID = 11; // Stop after this many differences.
+    const int STATS_ID = 12;  // Print out where the time went.
+    const int ALL_SPACE_ID = 13; // Ignore all white space.
+    const int SPACE_CHANGE_ID = 14; // Ignore changes in the amount of white space.
+    const int TRAILING_SPACE_ID = 15; // Ignore white space at the end of lines.
+    const int CASE_ID = 16;   // Ignore case differences.
+    const int START_LINE_ID = 17; // Compare from this line on.
+    const int END_LINE_ID = 18; // Compare up to and including this line.
+    const int SAVE_INDEX_ID = 19; // Keep the scan results next to each file.
+    const int BINARY_ID = 20; // Compare bytes instead of lines.
+    const int SIMILARITY_ID = 21; // Estimate how similar the files are.
+    const int SHINGLE_ID = 22; // Lines per shingle of the similarity estimate.
+    const int MEMORY_LIMIT_ID = 23; // Diff within this much memory (MiB).
+    const int FOLLOW_ID = 24; // Keep comparing the lines the files gain.
+    const int SERVE_ID = 25;  // Serve comparisons on this Unix domain socket.
+    const int CONNECT_ID = 26; // Compare on the server at this socket.
+    const int VERSION_ID = 27; // Print out version/about information.
+    const int HELP_ID = 28;   // Print out usage help.
 
     AbeArgs::Parser parser;
     parser.addArgument({ AbeArgs::REQUIRED, FILE_A_ID, "a", "file-a", "File a to compare.", AbeArgs::FILE_TYPE, 1 });
-    parser.addArgument({ AbeArgs::REQUIRED, FILE_B_ID, "b", "file-b", "File b to compare.", AbeArgs::FILE_TYPE, 1 });
+    parser.addArgument({ AbeArgs::REQUIRED, FILE_B_ID, "b", "file-b", "File b to compare, or @manifest to compare file a with every file listed in it.", AbeArgs::STRING_TYPE, 1 });
     parser.addArgument({ AbeArgs::SWITCH, FILE_IG_ID, "i", "ignore-le", "Ignore differences in line endings." });
     parser.addArgument({ AbeArgs::SWITCH, NAIVE_ID, "n", "naive", "Use a naive comparison (skip the line count check)." });
     parser.addArgument({ AbeArgs::SWITCH, QUIET_ID, "q", "quiet", "Only print the final result." });
+    parser.addArgument({ AbeArgs::OPTIONAL, JOBS_ID, "j", "jobs", "Compare with N threads (0 uses every core).", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, DIFF_ALG_ID, "d", "diff-algorithm", "Line matching: positional, myers, patience or histogram.", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, CACHE_ID, "c", "cache", "Cache scan results of unchanged files in this directory.", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::SWITCH, STREAM_ID, "s", "stream", "Stream the files with read-ahead (the default for pipes and - for stdin)." });
+    parser.addArgument({ AbeArgs::OPTIONAL, FORMAT_ID, "f", "format", "Output format: text, unified or json (JSON lines).", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, MAX_DIFFS_ID, "m", "max-diffs", "Stop after N differences (0 for no limit).", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::SWITCH, STATS_ID, "t", "stats", "Report the time, bytes and lines of each phase, syscalls and allocations." });
+    parser.addArgument({ AbeArgs::SWITCH, ALL_SPACE_ID, "w", "ignore-all-space", "Ignore all white space." });
+    parser.addArgument({ AbeArgs::SWITCH, SPACE_CHANGE_ID, "W", "ignore-space-change", "Ignore changes in the amount of white space." });
+    parser.addArgument({ AbeArgs::SWITCH, TRAILING_SPACE_ID, "Z", "ignore-trailing-space", "Ignore white space at the end of lines." });
+    parser.addArgument({ AbeArgs::SWITCH, CASE_ID, "I", "ignore-case", "Ignore case differences (ASCII letters)." });
+    parser.addArgument({ AbeArgs::OPTIONAL, START_LINE_ID, "l", "start-line", "Compare from line N on (one based).", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, END_LINE_ID, "e", "end-line", "Compare up to and including line N (0 for the last line).", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::SWITCH, SAVE_INDEX_ID, "x", "save-index", "Keep the scan results (line checkpoints, counts, digest) next to each file and reuse them while it is unchanged." });
+    parser.addArgument({ AbeArgs::SWITCH, BINARY_ID, "B", "binary", "Compare the files byte by byte and list each differing byte, like cmp -l." });
+    parser.addArgument({ AbeArgs::SWITCH, SIMILARITY_ID, "S", "similarity", "Estimate how similar the files are, overall and region by region, instead of listing differences." });
+    parser.addArgument({ AbeArgs::OPTIONAL, SHINGLE_ID, "k", "shingle", "Hash N consecutive lines together for --similarity.", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, MEMORY_LIMIT_ID, "M", "memory-limit", "Diff files larger than memory within N MiB, sorting line hashes on disk (0 for no limit).", AbeArgs::INT_TYPE, 1 });
+    parser.addArgument({ AbeArgs::SWITCH, FOLLOW_ID, "F", "follow", "Keep following growing files (logs) and compare only the lines they gain, until interrupted." });
+    parser.addArgument({ AbeArgs::OPTIONAL, SERVE_ID, "D", "serve", "Serve batches of comparisons, made with these options, on a Unix domain socket until interrupted.", AbeArgs::STRING_TYPE, 1 });
+    parser.addArgument({ AbeArgs::OPTIONAL, CONNECT_ID, "C", "connect", "Send -a and -b (or -b @manifest) to the server at this socket, which compares them with its own options.", AbeArgs::STRING_TYPE, 1 });
     parser.addArgument({ AbeArgs::X_SWITCH, VERSION_ID, "v", "version", "Show version information and exit." });
     parser.addArgument({ AbeArgs::X_SWITCH, HELP_ID, "h", "help", "Show this help information and exit." });
 
@@ -88,6 +766,60 @@ main(int argc, char** argv)
     // Default to verbose output.
     bool quiet = false;
     parser.getArgument(QUIET_ID).setDefaultValue(quiet);
+    // Default to a single thread.
+    int jobs = 1;
+    parser.getArgument(JOBS_ID).setDefaultValue(jobs);
+    // Default to comparing line i with line i.
+    AbeCmp::DiffAlgorithm algorithm = AbeCmp::DiffAlgorithm::POSITIONAL;
+    parser.getArgument(DIFF_ALG_ID).setDefaultValue(std::string(AbeCmp::getDiffAlgorithmName(algorithm)));
+    // Default to mapping regular files.
+    bool stream = false;
+    parser.getArgument(STREAM_ID).setDefaultValue(stream);
+    // Default to the text report.
+    AbeCmp::OutputFormat format = AbeCmp::OutputFormat::TEXT;
+    parser.getArgument(FORMAT_ID).setDefaultValue(std::string(AbeCmp::getOutputFormatName(format)));
+    // Default to reporting every difference.
+    int max_diffs = 0;
+    parser.getArgument(MAX_DIFFS_ID).setDefaultValue(max_diffs);
+    // Default to no stats.
+    bool stats = false;
+    parser.getArgument(STATS_ID).setDefaultValue(stats);
+    // Default to every difference counting.
+    AbeCmp::Normalization normalization;
+    parser.getArgument(ALL_SPACE_ID).setDefaultValue(normalization.ignore_all_space);
+    parser.getArgument(SPACE_CHANGE_ID).setDefaultValue(normalization.ignore_space_change);
+    parser.getArgument(TRAILING_SPACE_ID).setDefaultValue(normalization.ignore_trailing_space);
+    parser.getArgument(CASE_ID).setDefaultValue(normalization.ignore_case);
+    // Default to comparing every line.
+    int64_t start_line = 1;
+    parser.getArgument(START_LINE_ID).setDefaultValue(std::to_string(start_line));
+    int64_t end_line = 0;
+    parser.getArgument(END_LINE_ID).setDefaultValue(std::to_string(end_line));
+    // Default to not keeping scan results next to the files.
+    bool save_index = false;
+    parser.getArgument(SAVE_INDEX_ID).setDefaultValue(save_index);
+    // Default to comparing lines.
+    bool binary = false;
+    parser.getArgument(BINARY_ID).setDefaultValue(binary);
+    // Default to listing differences, and to single line shingles.
+    bool similarity = false;
+    parser.getArgument(SIMILARITY_ID).setDefaultValue(similarity);
+    int shingle_lines = 1;
+    parser.getArgument(SHINGLE_ID).setDefaultValue(shingle_lines);
+    // Default to diffing in memory.
+    int memory_limit = 0;
+    parser.getArgument(MEMORY_LIMIT_ID).setDefaultValue(memory_limit);
+    // Default to comparing the files once.
+    bool follow = false;
+    parser.getArgument(FOLLOW_ID).setDefaultValue(follow);
+
+    // Default to comparing in this process.
+    std::string serve_path, connect_path;
+
+    // The files are opened once all options are known.
+    std::string name_a, name_b;
+    // No scan cache unless a directory is given.
+    std::string cache_dir;
 
     AbeArgs::ParsedArguments_t results = parser.exec(argc, argv);
     if (parser.error()) {
@@ -99,16 +831,10 @@ main(int argc, char** argv)
         for (const auto& r : results) {
             switch (r.first) {
                 case FILE_A_ID:
-                    if (!file_a.open(std::get<std::string>(r.second))) {
-                        std::cerr << "\nerror: Opening file: " << file_a.getName() << "\n";
-                        return EXIT_FAILURE;
-                    }
+                    name_a = std::get<std::string>(r.second);
                     break;
                 case FILE_B_ID:
-                    if (!file_b.open(std::get<std::string>(r.second))) {
-                        std::cerr << "\nerror: Opening file: " << file_b.getName() << "\n";
-                        return EXIT_FAILURE;
-                    }
+                    name_b = std::get<std::string>(r.second);
                     break;
                 case FILE_IG_ID:
                     le_ignore = std::get<bool>(r.second);
@@ -119,6 +845,97 @@ main(int argc, char** argv)
                 case QUIET_ID:
                     quiet = std::get<bool>(r.second);
                     break;
+                case JOBS_ID:
+                    jobs = std::get<int>(r.second);
+                    if (jobs < 0) {
+                        std::cerr << "\nerror: The number of jobs can't be negative.\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case DIFF_ALG_ID:
+                    if (!AbeCmp::parseDiffAlgorithm(std::get<std::string>(r.second), algorithm)) {
+                        std::cerr << "\nerror: Unknown diff algorithm: " << std::get<std::string>(r.second) << "\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case CACHE_ID:
+                    cache_dir = std::get<std::string>(r.second);
+                    break;
+                case STREAM_ID:
+                    stream = std::get<bool>(r.second);
+                    break;
+                case FORMAT_ID:
+                    if (!AbeCmp::parseOutputFormat(std::get<std::string>(r.second), format)) {
+                        std::cerr << "\nerror: Unknown output format: " << std::get<std::string>(r.second) << "\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case MAX_DIFFS_ID:
+                    max_diffs = std::get<int>(r.second);
+                    if (max_diffs < 0) {
+                        std::cerr << "\nerror: The maximum number of differences can't be negative.\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case STATS_ID:
+                    stats = std::get<bool>(r.second);
+                    break;
+                case ALL_SPACE_ID:
+                    normalization.ignore_all_space = std::get<bool>(r.second);
+                    break;
+                case SPACE_CHANGE_ID:
+                    normalization.ignore_space_change = std::get<bool>(r.second);
+                    break;
+                case TRAILING_SPACE_ID:
+                    normalization.ignore_trailing_space = std::get<bool>(r.second);
+                    break;
+                case CASE_ID:
+                    normalization.ignore_case = std::get<bool>(r.second);
+                    break;
+                case START_LINE_ID:
+                    if (!parseLineNumber(std::get<std::string>(r.second), start_line) || start_line < 1) {
+                        std::cerr << "\nerror: The start line must be a line number from 1 on.\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case END_LINE_ID:
+                    if (!parseLineNumber(std::get<std::string>(r.second), end_line)) {
+                        std::cerr << "\nerror: The end line must be a line number, or 0 for the last line.\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case SAVE_INDEX_ID:
+                    save_index = std::get<bool>(r.second);
+                    break;
+                case BINARY_ID:
+                    binary = std::get<bool>(r.second);
+                    break;
+                case SIMILARITY_ID:
+                    similarity = std::get<bool>(r.second);
+                    break;
+                case SHINGLE_ID:
+                    shingle_lines = std::get<int>(r.second);
+                    if (shingle_lines < 1) {
+                        std::cerr << "\nerror: A shingle needs at least one line.\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case MEMORY_LIMIT_ID:
+                    memory_limit = std::get<int>(r.second);
+                    if (memory_limit < 0) {
+                        std::cerr << "\nerror: The memory limit can't be negative.\n";
+                        return EXIT_FAILURE;
+                    }
+                    break;
+                case FOLLOW_ID:
+                    follow = std::get<bool>(r.second);
+                    break;
+                case SERVE_ID:
+                    serve_path = std::get<std::string>(r.second);
+                    break;
+                case CONNECT_ID:
+                    connect_path = std::get<std::string>(r.second);
+                    break;
                 case VERSION_ID:
                     showAbout();
                     return EXIT_SUCCESS;
@@ -129,15 +946,231 @@ main(int argc, char** argv)
         }
     }
 
-    showAbout(1);
+    // Machine-readable formats keep stdout for the differences, the rest of the
+    // report goes to stderr.
+    const bool text = (format == AbeCmp::OutputFormat::TEXT);
+    FILE* info = text ? stdout : stderr;
+    std::ostream& info_os = text ? std::cout : std::cerr;
+    showAbout(1, info);
 
-    // Check if the required arguments were provided.
-    if (parser.isMissingRequiredArgs()) {
+    // Check if the required arguments were provided. A server gets its files
+    // from its clients.
+    if (serve_path.empty() && parser.isMissingRequiredArgs()) {
         std::cerr << "\nerror: Missing 1 or more required arguments.";
         std::cerr << "\n       Use -h or --help for more information.\n";
         return EXIT_FAILURE;
     }
 
+    AbeCmp::Stats::enable(stats);
+
+    if (save_index && !cache_dir.empty()) {
+        std::cerr << "\nerror: Use either a cache directory or --save-index, not both.\n";
+        return EXIT_FAILURE;
+    }
+    if (end_line > 0 && end_line < start_line) {
+        std::cerr << "\nerror: The end line comes before the start line.\n";
+        return EXIT_FAILURE;
+    }
+
+    // An empty cache directory keeps the entries next to the files.
+    std::unique_ptr<AbeCmp::ScanCache> cache;
+    if (!cache_dir.empty() || save_index) {
+        cache = std::make_unique<AbeCmp::ScanCache>(cache_dir);
+        if (!cache->init()) {
+            std::cerr << "\nerror: Using cache directory: " << cache_dir << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    const unsigned threads = (jobs == 0) ? std::max(1u, std::thread::hardware_concurrency()) : static_cast<unsigned>(jobs);
+
+    // A server compares pairs of files like a tree comparison does.
+    const bool ranged = start_line > 1 || end_line > 0;
+    if (!serve_path.empty() || !connect_path.empty()) {
+        if ((!serve_path.empty() && !connect_path.empty()) || binary || similarity || follow || memory_limit > 0 || ranged || stream || !text) {
+            std::cerr << "\nerror: A server or its client takes the text format, and no line range, memory limit, --stream, --binary, --similarity or --follow.\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (!serve_path.empty()) {
+        // The latest scans stay in memory, in front of any cache on disk.
+        const size_t server_cache_entries = 4096;
+        if (!cache)
+            cache = std::make_unique<AbeCmp::ScanCache>(std::string());
+        cache->keepInMemory(server_cache_entries, cache_dir.empty() && !save_index);
+
+        AbeCmp::TreeOptions server_options;
+        server_options.le_ignore = le_ignore;
+        server_options.naive = naive;
+        server_options.quiet = quiet;
+        server_options.algorithm = algorithm;
+        server_options.jobs = threads;
+        server_options.cache = cache.get();
+        server_options.max_diffs = max_diffs;
+        server_options.normalization = normalization;
+        return serveComparisons(serve_path, server_options);
+    }
+
+    // A -b of @manifest compares file a, the reference, with every file listed in
+    // the manifest.
+    const bool many = name_b.size() > 1 && name_b[0] == '@';
+    std::vector<std::string> candidates;
+    if (many && !readManifest(name_b.substr(1), candidates)) {
+        std::cerr << "\nerror: Reading manifest: " << name_b.substr(1) << "\n";
+        return EXIT_FAILURE;
+    }
+    if (!connect_path.empty()) {
+        std::vector<AbeCmp::FilePair> pairs;
+        for (const std::string& candidate : many ? candidates : std::vector<std::string>{ name_b })
+            pairs.emplace_back(name_a, candidate);
+        return compareRemote(connect_path, pairs);
+    }
+
+    // Compare two directory trees file by file.
+    std::error_code fs_error;
+    const bool dir_a = std::filesystem::is_directory(name_a, fs_error);
+    const bool dir_b = std::filesystem::is_directory(name_b, fs_error);
+    if (dir_a != dir_b && !many) {
+        std::cerr << "\nerror: Both -a and -b must be directories to compare trees.\n";
+        return EXIT_FAILURE;
+    }
+    // Only lines at the same position can be picked by number in both files.
+    if (ranged && (dir_a || many || algorithm != AbeCmp::DiffAlgorithm::POSITIONAL)) {
+        std::cerr << "\nerror: A line range needs two files and the positional comparison.\n";
+        return EXIT_FAILURE;
+    }
+    if ((dir_a || many) && !text) {
+        std::cerr << "\nerror: Directory trees and manifests can only be compared with the text format.\n";
+        return EXIT_FAILURE;
+    }
+    // The memory limit is for a diff of two files.
+    const uint64_t memory_bytes = static_cast<uint64_t>(memory_limit) << 20;
+    if (memory_limit > 0) {
+        if (binary || similarity || dir_a || many || ranged) {
+            std::cerr << "\nerror: A memory limit takes two files, and no line range, --binary or --similarity.\n";
+            return EXIT_FAILURE;
+        }
+        if (memory_bytes < AbeCmp::getMinimumMemoryLimit()) {
+            std::cerr << "\nerror: The memory limit must be at least " << (AbeCmp::getMinimumMemoryLimit() >> 20) << " MiB.\n";
+            return EXIT_FAILURE;
+        }
+    }
+    // Following picks lines up by their position where it left off.
+    if (follow && (binary || similarity || dir_a || many || ranged || memory_limit > 0 || algorithm != AbeCmp::DiffAlgorithm::POSITIONAL)) {
+        std::cerr << "\nerror: Following takes two files and the positional comparison, and no line range, memory limit, --binary or --similarity.\n";
+        return EXIT_FAILURE;
+    }
+    if (similarity) {
+        // The estimate reads both inputs front to back, with no line positions.
+        if (binary || dir_a || many || ranged || algorithm != AbeCmp::DiffAlgorithm::POSITIONAL || format == AbeCmp::OutputFormat::UNIFIED) {
+            std::cerr << "\nerror: A similarity estimate takes two files, the text or json format and no line range, diff algorithm or --binary.\n";
+            return EXIT_FAILURE;
+        }
+        return compareSimilarity(name_a, name_b, normalization, shingle_lines, format);
+    }
+    if (binary) {
+        // Bytes have no lines, so none of the line options apply.
+        if (dir_a || many || ranged || stream || le_ignore || naive || normalization.any() || algorithm != AbeCmp::DiffAlgorithm::POSITIONAL) {
+            std::cerr << "\nerror: A binary comparison takes two files and none of the line options.\n";
+            return EXIT_FAILURE;
+        }
+        if (format == AbeCmp::OutputFormat::UNIFIED || AbeCmp::StreamReader::isStream(name_a) || AbeCmp::StreamReader::isStream(name_b)) {
+            std::cerr << "\nerror: A binary comparison needs files that can be mapped and the text or json format.\n";
+            return EXIT_FAILURE;
+        }
+        return compareBinary(name_a, name_b, quiet, format, max_diffs);
+    }
+    if (dir_a || many) {
+        Timer timer;
+        timer.start();
+
+        AbeCmp::TreeOptions tree_options;
+        tree_options.le_ignore = le_ignore;
+        tree_options.naive = naive;
+        tree_options.quiet = quiet;
+        tree_options.algorithm = algorithm;
+        tree_options.jobs = threads;
+        tree_options.cache = cache.get();
+        tree_options.max_diffs = max_diffs;
+        tree_options.normalization = normalization;
+        AbeCmp::TreeSummary summary;
+        if (many) {
+            if (!AbeCmp::compareMany(name_a, candidates, tree_options, summary))
+                return EXIT_FAILURE;
+        } else if (!AbeCmp::compareTrees(name_a, name_b, tree_options, summary)) {
+            return EXIT_FAILURE;
+        }
+
+        printf("\n%ld files compared: %ld match, %ld differ, %ld could not be compared.\n",
+               summary.matched + summary.differed + summary.errors, summary.matched, summary.differed, summary.errors);
+        if (!many)
+            printf("%ld files only in a, %ld files only in b.\n", summary.only_a, summary.only_b);
+        timer.stop();
+        timer.printElapsed("Total time taken");
+        showStats(nullptr, std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    // A diff algorithm matches lines up by their hashes, so index the lines while scanning.
+    bool positional = (algorithm == AbeCmp::DiffAlgorithm::POSITIONAL);
+    const bool unified = (format == AbeCmp::OutputFormat::UNIFIED);
+
+    // gzip and zstd files are decompressed while they are read.
+    const AbeCmp::Compression compression_a = AbeCmp::detectFileCompression(name_a);
+    const AbeCmp::Compression compression_b = AbeCmp::detectFileCompression(name_b);
+    for (const AbeCmp::Compression compression : { compression_a, compression_b }) {
+        if (!AbeCmp::isCompressionSupported(compression)) {
+            std::cerr << "\nerror: This build can't read " << AbeCmp::getCompressionName(compression) << " compressed files.\n";
+            return EXIT_FAILURE;
+        }
+    }
+    const bool compressed = compression_a != AbeCmp::Compression::NONE || compression_b != AbeCmp::Compression::NONE;
+
+    // Only the tails of regular files can be picked up again.
+    if (follow) {
+        if (stream || compressed || AbeCmp::StreamReader::isStream(name_a) || AbeCmp::StreamReader::isStream(name_b)) {
+            std::cerr << "\nerror: Following needs regular uncompressed files, not streams.\n";
+            return EXIT_FAILURE;
+        }
+        return compareFollow(name_a, name_b, le_ignore, normalization, quiet, format, max_diffs, threads);
+    }
+
+    // Within a memory limit, a diff algorithm sorts the line hashes on disk
+    // instead of loading both files.
+    if (!positional && memory_limit > 0)
+        return compareExternal(name_a, name_b, algorithm, le_ignore, normalization, quiet, format, max_diffs, memory_bytes);
+
+    // Inputs that can't be mapped, and compressed files, are compared while they
+    // are read, in bounded memory. A diff algorithm needs all lines at once, and
+    // a line range picks lines by number, so they still load the whole files.
+    // Streams only know their line counts at the end, too late for a unified
+    // diff to match up the lines when the counts differ, so unified output loads
+    // compressed files too and doesn't take other streams.
+    if (positional && (stream || memory_limit > 0 || (compressed && !ranged && !unified) || AbeCmp::StreamReader::isStream(name_a) || AbeCmp::StreamReader::isStream(name_b))) {
+        if (ranged) {
+            std::cerr << "\nerror: A line range needs files that can be mapped, not streams.\n";
+            return EXIT_FAILURE;
+        }
+        if (unified && (AbeCmp::StreamReader::isStream(name_a) || AbeCmp::StreamReader::isStream(name_b))) {
+            std::cerr << "\nerror: Unified output needs files, not stdin or pipes.\n";
+            return EXIT_FAILURE;
+        }
+        if (unified) {
+            std::cerr << "\nerror: Unified output with --stream or --memory-limit needs a diff algorithm (-d).\n";
+            return EXIT_FAILURE;
+        }
+        return compareStreams(name_a, name_b, le_ignore, normalization, naive, quiet, format, max_diffs);
+    }
+
+    if (!file_a.open(name_a, !positional, cache.get())) {
+        std::cerr << "\nerror: Opening file: " << file_a.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+    if (!file_b.open(name_b, !positional, cache.get())) {
+        std::cerr << "\nerror: Opening file: " << file_b.getName() << "\n";
+        return EXIT_FAILURE;
+    }
+
 // Allow Debug builds to compare the same file for testing purposes.
 #ifdef RELEASE_BUILD
     // Check if the files are the same and exit if they are.
@@ -151,75 +1184,164 @@ main(int argc, char** argv)
     timer.start();
 
     const bool diff_line_endings = (file_a.getLineEnding() != file_b.getLineEnding());
-    std::cout << "\nFile a [" << file_a.getLineEnding() << "]: " << file_a.getName();
-    std::cout << "\nFile b [" << file_b.getLineEnding() << "]: " << file_b.getName() << "\n";
+    info_os << "\nFile a [" << file_a.getLineEnding() << "]: " << file_a.getName();
+    info_os << "\nFile b [" << file_b.getLineEnding() << "]: " << file_b.getName() << "\n";
+    showCompression("a", file_a, info);
+    showCompression("b", file_b, info);
+    showMixedLineEndings("a", file_a, info);
+    showMixedLineEndings("b", file_b, info);
     if (diff_line_endings)
-        printf("The files use different line endings.\n");
+        fprintf(info, "The files use different line endings.\n");
 
     if (le_ignore)
         // Ignore line endings/differences.
         // Use what each file has for a line ending.
-        printf("Ignoring line ending differences.\n");
+        fprintf(info, "Ignoring line ending differences.\n");
+    if (normalization.any())
+        fprintf(info, "Ignoring %s.\n", AbeCmp::describeNormalization(normalization).c_str());
+
+    // A unified diff must hold every line, which a positional comparison can't
+    // line up when the line counts differ, so the lines are matched up with myers.
+    if (unified && positional && !ranged && file_a.getLineCount() != file_b.getLineCount()) {
+        fprintf(info, "The line counts differ, so the unified diff matches up the lines with myers.\n");
+        algorithm = AbeCmp::DiffAlgorithm::MYERS;
+        positional = false;
+    }
+
+    AbeCmp::DiffWriter writer(format);
+    writer.writeHeader(file_a.getName(), file_b.getName());
+    AbeCmp::OutputSummary summary;
 
-    // Perform a line count check if not using a naive comparison.
-    if (!naive && (file_a.getLineCount() != file_b.getLineCount())) {
-        printf("\nThe files are not the same because the line counts do not match.");
-        std::cout << "\nFile a: " << file_a.getLineCount() << (file_a.getLineCount() == 1 ? " line." : " lines.");
-        std::cout << "\nFile b: " << file_b.getLineCount() << (file_b.getLineCount() == 1 ? " line.\n" : " lines.\n");
+    // A diff algorithm finds the inserted and deleted lines, so only a positional
+    // comparison stops at a line count mismatch.
+    // Perform a line count check if not using a naive comparison. A line range
+    // only looks at its own lines.
+    if (!naive && !ranged && positional && (file_a.getLineCount() != file_b.getLineCount())) {
+        fprintf(info, "\nThe files are not the same because the line counts do not match.");
+        info_os << "\nFile a: " << file_a.getLineCount() << (file_a.getLineCount() == 1 ? " line." : " lines.");
+        info_os << "\nFile b: " << file_b.getLineCount() << (file_b.getLineCount() == 1 ? " line.\n" : " lines.\n");
+        summary.line_counts_differ = true;
+        summary.lines_a = file_a.getLineCount();
+        summary.lines_b = file_b.getLineCount();
+        writer.writeSummary(summary);
+        writer.flush();
         timer.stop();
-        timer.printElapsed("Total time taken");
+        timer.printElapsed("Total time taken", info_os);
+        showStats(&writer, info_os);
         return EXIT_SUCCESS;
     }
 
     // Compare each file line by line.
     bool the_same = true;
-    long line_diffs = 0;
-    long line_count = 0;
+    bool stopped = false;
+    int64_t line_diffs = 0;
+    int64_t line_count = 0;
+    // The line in file a where --max-diffs stopped the comparison.
+    int64_t stop_line = 0;
     // Use the shortest line count to avoid out of bounds errors for a naive comparison.
-    const long shortest_line_count = std::min(file_a.getLineCount(), file_b.getLineCount());
-    std::string line_a, line_b;
-    for (long i = 0; i < shortest_line_count; ++i) {
-        line_a = file_a.readLine(diff_line_endings && !le_ignore);
-        line_b = file_b.readLine(diff_line_endings && !le_ignore);
-        ++line_count;
-        if (line_a.compare(line_b) != 0) {
-            if (the_same && !quiet)
-                printf("\n");
-
-            if (!quiet) {
-                printf("@@ %ld, line %ld\n", line_diffs + 1, i + 1);
-                std::cout << "File a: " << line_a << "\n";
-                std::cout << "File b: " << line_b << "\n";
-                printf("\n");
+    const int64_t shortest_line_count = std::min(file_a.getLineCount(), file_b.getLineCount());
+    // The zero based lines [first_line, last_line) to compare.
+    const int64_t first_line = start_line - 1;
+    const int64_t last_line = (end_line > 0) ? std::min(end_line, shortest_line_count) : shortest_line_count;
+    if (first_line >= shortest_line_count) {
+        std::cerr << "\nerror: The start line is past the end of the files.\n";
+        return EXIT_FAILURE;
+    }
+    // A range starts at its checkpoint in both files instead of at the top.
+    AbeCmp::MatchPoint from;
+    from.offset_a = file_a.findLine(first_line);
+    from.offset_b = file_b.findLine(first_line);
+    from.line = first_line;
+    // Skip over the equal part of the files with a block compare and only
+    // compare line by line from the first line that differs. The block compare
+    // doesn't stop at the end of a range, so a range is compared line by line.
+    const bool le_differ = AbeCmp::lineEndingsDiffer(file_a, file_b);
+    const AbeCmp::MatchPoint start = ranged ? from : AbeCmp::findFirstDifference(file_a, file_b, le_ignore && le_differ, from);
+
+    AbeCmp::CompareOptions options;
+    options.le_ignore = le_ignore;
+    options.with_pretty_le = le_differ && !le_ignore;
+    options.keep_lines = !quiet;
+    options.jobs = threads;
+    options.normalization = normalization;
+
+    int64_t hunk_count = 0;
+    int64_t lines_only_a = 0;
+    int64_t lines_only_b = 0;
+    if (!start.identical && !positional) {
+        const std::vector<AbeCmp::Hunk> hunks = AbeCmp::diffFiles(file_a, file_b, start, algorithm, le_ignore, normalization);
+        for (const auto& hunk : hunks) {
+            if (max_diffs > 0 && hunk_count == max_diffs) {
+                stopped = true;
+                stop_line = hunk.a_first;
+                break;
             }
+            if (!quiet)
+                writer.writeHunk(file_a, file_b, hunk, hunk_count + 1, options.with_pretty_le);
             the_same = false;
-            line_diffs++;
+            ++hunk_count;
+            lines_only_a += hunk.a_count;
+            lines_only_b += hunk.b_count;
         }
+    } else if (!start.identical) {
+        AbeCmp::compareLines(file_a, file_b, start, last_line, options, [&](const AbeCmp::LineDiff& diff) {
+            if (max_diffs > 0 && line_diffs == max_diffs) {
+                stopped = true;
+                stop_line = diff.line;
+                return false;
+            }
+            if (!quiet)
+                writer.writeLineDiff(diff, line_diffs + 1);
+            the_same = false;
+            line_diffs++;
+            return true;
+        });
     }
+    writer.flush();
+    line_count = last_line - first_line;
 
     if (quiet)
-        printf("\n");
+        fprintf(info, "\n");
 
     // Report the results.
     if (the_same) {
         if (diff_line_endings)
-            printf("\nThe file contents match, but they have different line endings.\n");
+            fprintf(info, "\nThe file contents match, but they have different line endings.\n");
         else
-            printf("\nThe files match");
+            fprintf(info, "\nThe files match");
 
-        if (naive)
-            printf(" up to line %ld.\n", line_count);
+        if (ranged)
+            fprintf(info, " in lines %lld to %lld.\n", static_cast<long long>(first_line + 1), static_cast<long long>(last_line));
+        else if (naive)
+            fprintf(info, " up to line %lld.\n", static_cast<long long>(line_count));
         else
-            printf(" and have the same line count.\n");
+            fprintf(info, " and have the same line count.\n");
 
-        printf("%ld lines were compared.\n", line_count);
+        fprintf(info, "%lld lines were compared.\n", static_cast<long long>(line_count));
     } else {
-        printf("The files don't match.\n");
-        printf("%ld of %ld lines were different.\n", line_diffs, line_count);
+        fprintf(info, "The files don't match.\n");
+        if (stopped) {
+            fprintf(info, "Stopped after %lld %s.\n", static_cast<long long>(positional ? line_diffs : hunk_count), positional ? "different lines" : "hunks");
+            // The line that stopped the comparison is where to pick it up again.
+            if (positional)
+                fprintf(info, "Resume with --start-line %lld.\n", static_cast<long long>(stop_line + 1));
+        } else if (positional)
+            fprintf(info, "%lld of %lld lines were different.\n", static_cast<long long>(line_diffs), static_cast<long long>(line_count));
+        else
+            fprintf(info, "%lld hunks differ: %lld lines only in file a, %lld lines only in file b.\n", static_cast<long long>(hunk_count), static_cast<long long>(lines_only_a),
+                    static_cast<long long>(lines_only_b));
     }
 
+    summary.match = the_same;
+    summary.compared = stopped ? stop_line - first_line : line_count;
+    summary.differences = positional ? line_diffs : hunk_count;
+    summary.stopped = stopped;
+    writer.writeSummary(summary);
+    writer.flush();
+
     timer.stop();
-    timer.printElapsed("Total time taken");
+    timer.printElapsed("Total time taken", info_os);
+    showStats(&writer, info_os);
 
     return EXIT_SUCCESS;
 }